@@ -0,0 +1,45 @@
+#include "Arena.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+Arena::Arena() : current(0), offset(0) {
+}
+
+Arena::~Arena() {
+    for (const Chunk& chunk : chunks) {
+        free(chunk.data);
+    }
+}
+
+void* Arena::allocate(size_t size, size_t align) {
+    while (current < chunks.size()) {
+        Chunk& chunk = chunks[current];
+        uintptr_t base = uintptr_t(chunk.data);
+        size_t aligned = ((base + offset + align - 1) & ~uintptr_t(align - 1)) - base;
+        if (aligned + size <= chunk.size) {
+            offset = aligned + size;
+            return chunk.data + aligned;
+        }
+        // Current chunk exhausted, move on to the next one kept from earlier transactions
+        current++;
+        offset = 0;
+    }
+
+    // Out of chunks: grow, large requests get a chunk of their own
+    size_t chunk_size = default_chunk_size;
+    while (chunk_size < size + align) chunk_size *= 2;
+    char* data = static_cast<char*>(malloc(chunk_size));
+    if (!data) {
+        throw std::bad_alloc();
+    }
+    chunks.push_back(Chunk{data, chunk_size});
+    current = chunks.size() - 1;
+    offset = 0;
+    return allocate(size, align);
+}
+
+void Arena::reset() {
+    current = 0;
+    offset = 0;
+}
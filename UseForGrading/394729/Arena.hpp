@@ -0,0 +1,34 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// Bump allocator for per-transaction data.
+// Memory is never returned individually: reset() rewinds the arena and keeps
+// its chunks, so a warmed-up arena serves further transactions without
+// touching the heap.
+class Arena {
+private:
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    size_t current; // Index of the chunk being carved
+    size_t offset;  // First free byte in the current chunk
+
+    static constexpr size_t default_chunk_size = 64 * 1024;
+
+public:
+    Arena();
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(size_t size, size_t align = alignof(std::max_align_t));
+    void reset();
+};
+
+#endif // ARENA_H
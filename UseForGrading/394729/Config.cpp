@@ -0,0 +1,133 @@
+#include "Config.hpp"
+#include "Policy.hpp"
+#include "SegmentDirectory.hpp"
+#include <cstdlib>
+#include <cstring>
+
+// Stripe count bounds when derived from the region size
+static constexpr size_t min_lock_count = size_t(1) << 16;
+static constexpr size_t max_lock_count = size_t(1) << 22;
+// Stripes per word of the first segment, leaves room for later tm_alloc segments
+static constexpr size_t locks_per_word = 4;
+// Largest stripe, in words
+static constexpr size_t max_stripe_words = 4096;
+// Read sets log stripes as 32-bit indices
+static constexpr size_t max_explicit_lock_count = size_t(1) << 31;
+
+// Read a positive integer from the environment, 0 if unset or invalid
+static size_t env_size(const char* name) {
+    const char* value = std::getenv(name);
+    if (!value) return 0;
+    char* end;
+    unsigned long long parsed = std::strtoull(value, &end, 0);
+    return (end == value) ? 0 : size_t(parsed);
+}
+
+// Read a boolean flag from the environment, 'fallback' if unset
+static bool env_flag(const char* name, bool fallback) {
+    const char* value = std::getenv(name);
+    if (!value || !*value) return fallback;
+    return std::strtoull(value, nullptr, 0) != 0;
+}
+
+// Clock scheme by name, 'fallback' if unset or unknown
+static ClockScheme env_clock(const char* name, ClockScheme fallback) {
+    const char* value = std::getenv(name);
+    if (!value) return fallback;
+    if (std::strcmp(value, "gv1") == 0) return ClockScheme::gv1;
+    if (std::strcmp(value, "gv4") == 0) return ClockScheme::gv4;
+    if (std::strcmp(value, "gv5") == 0) return ClockScheme::gv5;
+    if (std::strcmp(value, "gv6") == 0) return ClockScheme::gv6;
+    if (std::strcmp(value, "partitioned") == 0) return ClockScheme::partitioned;
+    if (std::strcmp(value, "tsc") == 0) return ClockScheme::tsc;
+    return fallback;
+}
+
+// Engine by name, 'fallback' if unset or unknown
+static Engine env_engine(const char* name, Engine fallback) {
+    const char* value = std::getenv(name);
+    if (!value) return fallback;
+    if (std::strcmp(value, "tl2") == 0) return Engine::tl2;
+    if (std::strcmp(value, "norec") == 0) return Engine::norec;
+    if (std::strcmp(value, "ring") == 0) return Engine::ring;
+    return fallback;
+}
+
+// Contention policy by name, 'fallback' if unset or unknown
+static ContentionPolicy env_contention(const char* name, ContentionPolicy fallback) {
+    const char* value = std::getenv(name);
+    if (!value) return fallback;
+    if (std::strcmp(value, "suicide") == 0) return ContentionPolicy::suicide;
+    if (std::strcmp(value, "backoff") == 0) return ContentionPolicy::backoff;
+    if (std::strcmp(value, "karma") == 0) return ContentionPolicy::karma;
+    if (std::strcmp(value, "polka") == 0) return ContentionPolicy::polka;
+    if (std::strcmp(value, "greedy") == 0) return ContentionPolicy::greedy;
+    return fallback;
+}
+
+// A policy variant build (see Policy.hpp) ignores the variables of the choices it fixes
+Config Config::from_environment(size_t size, size_t align) {
+    Config config;
+
+    // TM_LOCKS: explicit stripe count, otherwise scale with the number of words
+    config.lock_count = env_size("TM_LOCKS");
+    if (config.lock_count == 0) {
+        size_t wanted = size / align * locks_per_word;
+        config.lock_count = wanted < min_lock_count ? min_lock_count : wanted > max_lock_count ? max_lock_count : wanted;
+    } else if (config.lock_count > max_explicit_lock_count) {
+        config.lock_count = max_explicit_lock_count;
+    }
+
+    // TM_STRIPE_WORDS: words per stripe, rounded up to a power of two (default 1)
+    config.stripe_words = 1;
+    size_t stripe_words = env_size("TM_STRIPE_WORDS");
+    while (config.stripe_words < stripe_words && config.stripe_words < max_stripe_words) {
+        config.stripe_words <<= 1;
+    }
+    // TM_STRIPE_ADAPTIVE: non-zero adapts the stripe size of new segments
+    config.adaptive_stripes = env_flag("TM_STRIPE_ADAPTIVE", false);
+
+    // TM_MULTIVERSION: non-zero enables the multiversion mode
+    config.multiversion = Policy::fixed ? Policy::multiversion : env_flag("TM_MULTIVERSION", false);
+    // TM_EXTENSION: zero disables timestamp extension
+    config.extension = env_flag("TM_EXTENSION", true);
+    // TM_CLOCK: gv1 (default), gv4, gv5, gv6, partitioned or tsc
+    config.clock = Policy::fixed ? Policy::clock : env_clock("TM_CLOCK", ClockScheme::gv1);
+    // TM_LOCKING: ctl (commit-time, default) or etl (encounter-time)
+    const char* locking = std::getenv("TM_LOCKING");
+    config.eager = Policy::fixed ? Policy::eager : locking && std::strcmp(locking, "etl") == 0;
+    // The history is filled at commit from the values about to be overwritten,
+    // in-place writes have overwritten them already
+    if (config.eager) {
+        config.multiversion = false;
+    }
+    // TM_COLOCATE: largest colocated segment in bytes (default 0, disabled). The
+    // lock and the word share 16 bytes, and the history is indexed by lock table stripe.
+    config.colocate_max = env_size("TM_COLOCATE");
+    if (align > SegmentDirectory::colocated_stride - sizeof(VersionedLock) || config.multiversion) {
+        config.colocate_max = 0;
+    } else if (config.colocate_max > SegmentDirectory::max_colocated_words * align) {
+        config.colocate_max = SegmentDirectory::max_colocated_words * align;
+    }
+    // TM_CONTENTION: suicide (default), backoff, karma, polka or greedy
+    config.contention = Policy::fixed ? Policy::contention : env_contention("TM_CONTENTION", ContentionPolicy::suicide);
+    // TM_IRREVOCABLE: consecutive aborts before a retry runs irrevocably (default 0, never)
+    config.irrevocable_after = env_size("TM_IRREVOCABLE");
+    // TM_FALLBACK: non-zero lets the region fall back to a global reader-writer lock
+    config.fallback = env_flag("TM_FALLBACK", false);
+
+    // TM_ENGINE: tl2 (default), norec or ring. NOrec and RingSTM keep no
+    // per-stripe metadata: the TL2 options above but TM_CONTENTION and
+    // TM_IRREVOCABLE do not apply, and the lock table is left minimal.
+    config.engine = Policy::fixed ? Policy::engine : env_engine("TM_ENGINE", Engine::tl2);
+    if (config.engine != Engine::tl2) {
+        config.lock_count = 1;
+        config.adaptive_stripes = false;
+        config.multiversion = false;
+        config.eager = false;
+        config.colocate_max = 0;
+        config.fallback = false;
+    }
+
+    return config;
+}
@@ -0,0 +1,35 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <cstddef>
+#include "ContentionManager.hpp"
+#include "VersionClock.hpp"
+
+// Algorithm running the transactions of a region
+enum class Engine {
+    tl2,   // Versioned stripe locks and a global version clock
+    norec, // Global sequence lock, value-based validation
+    ring,  // RingSTM: global ring of write signatures, read signature validation
+};
+
+// Tunables of a shared memory region, fixed at tm_create.
+// Defaults are derived from the region geometry and can be overridden
+// through environment variables (see Config.cpp).
+struct Config {
+    Engine engine;
+    size_t lock_count; // Number of stripes in the lock table (rounded up to a power of two)
+    size_t stripe_words; // Words covered by one stripe (a power of two)
+    bool adaptive_stripes; // Pick the stripe size of new segments from the observed access pattern
+    bool multiversion; // Keep overwritten values so read-only transactions read their snapshot and never abort
+    bool extension;    // Extend the read version (revalidating the read set) instead of aborting on newer stripes
+    ClockScheme clock; // Global version clock scheme
+    bool eager;        // Encounter-time locking: lock in tm_write, write in place, undo on abort
+    size_t colocate_max; // Segments up to this size (bytes) keep each word next to its lock, 0 disables
+    ContentionPolicy contention; // What to do on a stripe locked by another transaction, and after an abort
+    size_t irrevocable_after; // Consecutive aborts after which a read-write transaction runs irrevocably, 0 never
+    bool fallback; // Switch to a global reader-writer lock while aborts are as frequent as commits
+
+    static Config from_environment(size_t size, size_t align);
+};
+
+#endif // CONFIG_H
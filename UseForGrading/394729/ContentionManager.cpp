@@ -0,0 +1,108 @@
+#include "ContentionManager.hpp"
+
+#include <atomic>
+#include <thread>
+
+#include "Policy.hpp"
+#include "ThreadRegistry.hpp"
+#include "macros.h"
+
+// Spins of one wait attempt on a locked stripe
+static constexpr unsigned int wait_spins = 128;
+// Spins before yielding the processor to the lock owner
+static constexpr unsigned int spin_yield_period = 64;
+// Cap on the number of wait attempts and on the backoff exponent
+static constexpr uint64_t max_wait_attempts = 16;
+static constexpr uint64_t max_backoff_shift = 12;
+
+// Start stamps for the greedy policy, only older transactions get smaller ones
+static std::atomic<uint64_t> greedy_ticket{1};
+
+static void spin(uint64_t iterations) {
+    for (uint64_t i = 1; i <= iterations; i++) {
+        if (i % spin_yield_period == 0) {
+            std::this_thread::yield();
+        } else {
+            cpu_relax();
+        }
+    }
+}
+
+// Policy of this build: a policy variant fixes it (see Policy.hpp)
+static inline ContentionPolicy effective(ContentionPolicy configured) {
+    return Policy::fixed ? Policy::contention : configured;
+}
+
+ContentionManager::ContentionManager(ContentionPolicy policy) : policy(policy) {
+}
+
+void ContentionManager::on_begin(Transaction* transaction) {
+    if (transaction->get_aborts() != 0) {
+        return; // A retry keeps the priority of the first attempt
+    }
+    switch (effective(policy)) {
+    case ContentionPolicy::greedy:
+        // Older transactions have the higher priority
+        transaction->publish_priority(UINT64_MAX - greedy_ticket.fetch_add(1, std::memory_order_relaxed));
+        break;
+    case ContentionPolicy::karma:
+    case ContentionPolicy::polka:
+        transaction->publish_priority(0);
+        break;
+    default:
+        break;
+    }
+}
+
+void ContentionManager::on_lock(Transaction* transaction) {
+    if (effective(policy) == ContentionPolicy::karma || effective(policy) == ContentionPolicy::polka) {
+        transaction->publish_priority(transaction->get_karma() + transaction->get_work());
+    }
+}
+
+void ContentionManager::back_off(Transaction* transaction) {
+    thread_local uint64_t seed = 0x2545F4914F6CDD1DULL ^ uint64_t(uintptr_t(transaction));
+    // xorshift64
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    uint64_t shift = transaction->get_aborts() < max_backoff_shift ? transaction->get_aborts() : max_backoff_shift;
+    spin(seed % (wait_spins << shift));
+}
+
+void ContentionManager::on_abort(Transaction* transaction) {
+    if (effective(policy) == ContentionPolicy::backoff || effective(policy) == ContentionPolicy::polka) {
+        back_off(transaction);
+    }
+}
+
+bool ContentionManager::wait_for(Transaction* transaction, const VersionedLock* lock, uint64_t& word) {
+    if (effective(policy) == ContentionPolicy::suicide || effective(policy) == ContentionPolicy::backoff) {
+        return false;
+    }
+
+    Transaction* owner = ThreadRegistry::get(VersionedLock::owner_of(word));
+    uint64_t ours = effective(policy) == ContentionPolicy::greedy ? transaction->get_priority() : transaction->get_karma() + transaction->get_work();
+    uint64_t theirs = owner->get_priority();
+
+    uint64_t attempts;
+    if (effective(policy) == ContentionPolicy::greedy) {
+        // Younger transactions give way, older ones wait for the owner to finish
+        if (ours < theirs) return false;
+        attempts = max_wait_attempts;
+    } else {
+        // Wait longer the more work we would lose compared to the owner
+        attempts = 1 + (ours > theirs ? ours - theirs : 0);
+        if (attempts > max_wait_attempts) attempts = max_wait_attempts;
+    }
+
+    for (uint64_t attempt = 0; attempt < attempts; attempt++) {
+        uint64_t shift = effective(policy) == ContentionPolicy::polka ? (attempt < max_backoff_shift ? attempt : max_backoff_shift) : 0;
+        spin(wait_spins << shift);
+        word = lock->load();
+        if (!VersionedLock::is_locked(word)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,45 @@
+#ifndef CONTENTION_MANAGER_H
+#define CONTENTION_MANAGER_H
+
+#include <cstdint>
+
+#include "Transaction.hpp"
+#include "VersionedLock.hpp"
+
+enum class ContentionPolicy {
+    suicide, // abort on any conflict, retry right away
+    backoff, // abort on any conflict, randomized exponential backoff before the retry
+    karma,   // priority = work done across retries, wait on lower-or-equal priority owners
+    polka,   // karma, with exponentially growing waits between checks, and backoff
+    greedy   // priority = age of the first attempt, only older transactions wait
+};
+
+// Decides what a transaction does when it meets a stripe locked by another
+// transaction, and what happens between an abort and the retry. The per
+// thread bookkeeping (consecutive aborts, accumulated work, start stamp)
+// lives in the Transaction context, so a retried transaction keeps its
+// priority.
+class ContentionManager {
+private:
+    ContentionPolicy policy;
+
+    void back_off(Transaction* transaction);
+
+public:
+    explicit ContentionManager(ContentionPolicy policy);
+
+    ContentionPolicy get_policy() const { return policy; }
+
+    // A (retried) transaction begins
+    void on_begin(Transaction* transaction);
+    // The transaction is about to lock stripes, publish its priority for waiters
+    void on_lock(Transaction* transaction);
+    // The transaction aborted, called before it is reset
+    void on_abort(Transaction* transaction);
+
+    // 'lock' was found locked (in 'word') by another transaction. Returns
+    // true with 'word' reloaded once it is released, or false to abort.
+    bool wait_for(Transaction* transaction, const VersionedLock* lock, uint64_t& word);
+};
+
+#endif // CONTENTION_MANAGER_H
@@ -0,0 +1,105 @@
+#include "EpochManager.hpp"
+#include "macros.h"
+
+EpochManager::EpochManager(Reclaim reclaim, void* context) : reclaim(reclaim), context(context) {
+}
+
+EpochManager::~EpochManager() {
+    for (Slot& slot : slots) {
+        delete[] slot.limbo;
+    }
+}
+
+void EpochManager::enter(size_t slot) {
+    // Re-check after publishing: an advance that missed our store must not
+    // leave us running in an epoch it already considered drained
+    uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+    for (;;) {
+        slots[slot].epoch.store(epoch, std::memory_order_seq_cst);
+        uint64_t current = global_epoch.load(std::memory_order_seq_cst);
+        if (current == epoch) {
+            return;
+        }
+        epoch = current;
+    }
+}
+
+bool EpochManager::try_advance() {
+    uint64_t epoch = global_epoch.load(std::memory_order_seq_cst);
+    size_t slot_count = ThreadRegistry::high_water();
+    for (size_t slot = 0; slot < slot_count; slot++) {
+        uint64_t local = slots[slot].epoch.load(std::memory_order_seq_cst);
+        if (local != quiescent && local != epoch) {
+            return false;
+        }
+    }
+    return global_epoch.compare_exchange_strong(epoch, epoch + 1, std::memory_order_seq_cst);
+}
+
+void EpochManager::lock(Slot& slot) {
+    while (slot.busy.exchange(true, std::memory_order_acquire)) {
+        cpu_relax();
+    }
+}
+
+void EpochManager::retire(size_t slot, void* block) {
+    Slot& own = slots[slot];
+    lock(own);
+    size_t pending = own.pending.load(std::memory_order_relaxed);
+    if (pending == own.capacity) {
+        // Full (or first use): grow, oldest first again
+        size_t capacity = own.capacity ? own.capacity * 2 : initial_limbo;
+        Retired* limbo = new Retired[capacity];
+        for (size_t i = 0; i < pending; i++) {
+            limbo[i] = own.limbo[(own.head + i) % own.capacity];
+        }
+        delete[] own.limbo;
+        own.limbo = limbo;
+        own.capacity = capacity;
+        own.head = 0;
+    }
+    own.limbo[(own.head + pending) % own.capacity] = {global_epoch.load(std::memory_order_seq_cst), block};
+    own.pending.store(pending + 1, std::memory_order_relaxed);
+    unlock(own);
+}
+
+void EpochManager::drain(Slot& slot, size_t collector, uint64_t epoch) {
+    size_t pending = slot.pending.load(std::memory_order_relaxed);
+    while (pending > 0 && slot.limbo[slot.head].epoch + 2 <= epoch) {
+        reclaim(context, collector, slot.limbo[slot.head].block);
+        slot.head = (slot.head + 1) % slot.capacity;
+        pending--;
+    }
+    slot.pending.store(pending, std::memory_order_relaxed);
+}
+
+void EpochManager::collect(size_t slot) {
+    Slot& own = slots[slot];
+    bool help = ++own.collects % help_period == 0;
+    if (own.pending.load(std::memory_order_relaxed) == 0 && !help) {
+        return;
+    }
+    try_advance();
+
+    uint64_t epoch = global_epoch.load(std::memory_order_acquire);
+    if (own.pending.load(std::memory_order_relaxed) > 0) {
+        lock(own);
+        drain(own, slot, epoch);
+        unlock(own);
+    }
+    if (!help) {
+        return;
+    }
+    // Segments stranded by slots that stopped committing
+    size_t slot_count = ThreadRegistry::high_water();
+    for (size_t other = 0; other < slot_count; other++) {
+        Slot& idle = slots[other];
+        if (other == slot || idle.pending.load(std::memory_order_relaxed) == 0 || idle.epoch.load(std::memory_order_relaxed) != quiescent) {
+            continue;
+        }
+        if (!idle.busy.exchange(true, std::memory_order_acquire)) {
+            drain(idle, slot, epoch);
+            unlock(idle);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef EPOCH_MANAGER_H
+#define EPOCH_MANAGER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "ThreadRegistry.hpp"
+
+// Epoch-based reclamation of the segments freed by committed transactions.
+// Every transaction runs inside the epoch it read at tm_begin. A segment
+// unlinked by a commit is retired with the epoch current at that time and
+// handed to the reclaim function once the global epoch is two epochs ahead:
+// by then every transaction that could still hold its address has ended.
+// The global epoch only advances when no active transaction lags behind it.
+//
+// The limbo of a slot is a ring that only grows when full, so retiring costs
+// no allocation in the steady state. A thread that stops committing (or
+// exits) would strand its limbo: every help_period collects, a slot also
+// reclaims the expired segments of the quiescent slots it finds.
+class EpochManager {
+public:
+    // Called with the context, the collecting slot and the retired segment
+    using Reclaim = void (*)(void* context, size_t slot, void* segment);
+
+private:
+    static constexpr uint64_t quiescent = UINT64_MAX;
+    static constexpr size_t initial_limbo = 64;
+    static constexpr uint64_t help_period = 64;
+
+    struct Retired {
+        uint64_t epoch;
+        void* block;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> epoch{quiescent}; // Epoch of the running transaction, quiescent if none
+        std::atomic<bool> busy{false};          // Limbo held by the owner or a helper
+        std::atomic<size_t> pending{0};         // Entries in the limbo, read without holding it
+        Retired* limbo = nullptr;               // Ring of retired segments, oldest at 'head'
+        size_t capacity = 0;
+        size_t head = 0;
+        uint64_t collects = 0;                  // Owner only
+    };
+
+    std::atomic<uint64_t> global_epoch{1};
+    Slot slots[ThreadRegistry::max_threads];
+    Reclaim reclaim;
+    void* context;
+
+    bool try_advance();
+    void lock(Slot& slot);
+    void unlock(Slot& slot) { slot.busy.store(false, std::memory_order_release); }
+    // Reclaim the entries of a held limbo retired before 'epoch' - 1, on behalf of 'collector'
+    void drain(Slot& slot, size_t collector, uint64_t epoch);
+
+public:
+    EpochManager(Reclaim reclaim, void* context);
+    ~EpochManager();
+    EpochManager(const EpochManager&) = delete;
+    EpochManager& operator=(const EpochManager&) = delete;
+
+    void enter(size_t slot);
+    void exit(size_t slot) { slots[slot].epoch.store(quiescent, std::memory_order_release); }
+
+    // Retire a segment unlinked by a transaction of the slot that just committed
+    void retire(size_t slot, void* block);
+    // Advance the epoch if possible, then recycle what the slot (and, now and
+    // then, the quiescent slots) retired long enough ago
+    void collect(size_t slot);
+};
+
+#endif // EPOCH_MANAGER_H
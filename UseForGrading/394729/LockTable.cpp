@@ -0,0 +1,32 @@
+#include "LockTable.hpp"
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+
+static unsigned int log2_pow2(size_t value) {
+    unsigned int log = 0;
+    while ((size_t(1) << log) < value) log++;
+    return log;
+}
+
+LockTable::LockTable(size_t count) {
+    // Round up to a power of two, at least 2 stripes so the hash shift stays below 64
+    bits = log2_pow2(count < 2 ? 2 : count);
+    this->count = size_t(1) << bits;
+
+    size_t bytes = this->count * sizeof(VersionedLock);
+    locks = static_cast<VersionedLock*>(aligned_alloc(cache_line, (bytes + cache_line - 1) / cache_line * cache_line));
+    if (!locks) {
+        throw std::runtime_error("Failed to allocate lock table.");
+    }
+    for (size_t i = 0; i < this->count; i++) {
+        new (&locks[i]) VersionedLock();
+    }
+}
+
+LockTable::~LockTable() {
+    for (size_t i = 0; i < count; i++) {
+        locks[i].~VersionedLock();
+    }
+    free(locks);
+}
@@ -0,0 +1,37 @@
+#ifndef LOCK_TABLE_H
+#define LOCK_TABLE_H
+
+#include <cstddef>
+#include <cstdint>
+#include "VersionedLock.hpp"
+
+// Contiguous, cache-line aligned array of versioned locks (stripes).
+// The number of stripes is a power of two so that a word address can be
+// mapped to its stripe with a shift and a multiplicative hash. The shift is
+// the stripe size: 2^shift bytes of a segment share one lock.
+class LockTable {
+private:
+    VersionedLock* locks;
+    size_t count;
+    unsigned int bits; // log2(count)
+
+public:
+    static constexpr size_t cache_line = 64;
+
+    explicit LockTable(size_t count);
+    ~LockTable();
+    LockTable(const LockTable&) = delete;
+    LockTable& operator=(const LockTable&) = delete;
+
+    size_t size() const { return count; }
+
+    // Index of the stripe covering the word at the given address, for stripes of 2^shift bytes
+    size_t stripe_of(const void* address, unsigned int shift) const {
+        uint64_t block = uint64_t(address) >> shift;
+        return (block * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - bits);
+    }
+
+    VersionedLock* get(size_t stripe) { return &locks[stripe]; }
+};
+
+#endif // LOCK_TABLE_H
@@ -0,0 +1,98 @@
+#include "ModeSwitch.hpp"
+
+#include <thread>
+
+#include "macros.h"
+
+// Commits between two decisions
+static constexpr uint64_t window = 4096;
+// Windows spent pessimistic after the first fallback, and at most
+static constexpr uint64_t initial_hold = 4;
+static constexpr uint64_t max_hold = 256;
+// Calm: less than one abort per this many commits
+static constexpr uint64_t calm_ratio = 8;
+// Spins before yielding the processor to the draining transactions
+static constexpr unsigned int spin_yield_period = 64;
+
+ModeSwitch::ModeSwitch(bool enabled) : enabled(enabled), hold(initial_hold), held(0), probing(false) {
+}
+
+bool ModeSwitch::enter(size_t slot) {
+    if (!enabled) {
+        return false;
+    }
+    // Publish, then re-check: a switch that missed our store must not let
+    // us run in the mode it just left
+    uint64_t current = state.load(std::memory_order_seq_cst);
+    for (;;) {
+        slots[slot].generation.store(current >> 1, std::memory_order_seq_cst);
+        uint64_t again = state.load(std::memory_order_seq_cst);
+        if (again == current) {
+            break;
+        }
+        current = again;
+    }
+    if (drained.load(std::memory_order_acquire) < (current >> 1)) {
+        wait_drained(slot, current >> 1);
+    }
+    return current & 1;
+}
+
+void ModeSwitch::wait_drained(size_t slot, uint64_t generation) {
+    size_t slot_count = ThreadRegistry::high_water();
+    for (size_t other = 0; other < slot_count; other++) {
+        if (other == slot) {
+            continue;
+        }
+        for (unsigned int spins = 1;; spins++) {
+            uint64_t running = slots[other].generation.load(std::memory_order_seq_cst);
+            if (running == idle || running >= generation) {
+                break;
+            }
+            if (spins % spin_yield_period == 0) {
+                std::this_thread::yield();
+            } else {
+                cpu_relax();
+            }
+        }
+    }
+    uint64_t known = drained.load(std::memory_order_relaxed);
+    while (known < generation && !drained.compare_exchange_weak(known, generation, std::memory_order_release)) {
+    }
+}
+
+void ModeSwitch::report(const AccessStats& stats) {
+    aborts.fetch_add(stats.aborts, std::memory_order_relaxed);
+    uint64_t before = commits.fetch_add(stats.commits, std::memory_order_relaxed);
+    // The report crossing the window decides
+    if (before < window && before + stats.commits >= window) {
+        adapt();
+    }
+}
+
+void ModeSwitch::adapt() {
+    std::lock_guard<std::mutex> guard(deciding);
+    uint64_t window_aborts = aborts.exchange(0, std::memory_order_relaxed);
+    uint64_t window_commits = commits.exchange(0, std::memory_order_relaxed);
+
+    uint64_t current = state.load(std::memory_order_relaxed);
+    bool pessimistic = current & 1;
+    bool switching = false;
+    if (pessimistic) {
+        // No aborts to observe here, stay for the hold then probe
+        switching = ++held >= hold;
+    } else if (window_aborts >= window_commits) {
+        if (probing && hold < max_hold) {
+            hold *= 2;
+        }
+        switching = true;
+    } else if (probing && window_aborts * calm_ratio < window_commits) {
+        hold = initial_hold;
+    }
+
+    probing = switching && pessimistic;
+    if (switching) {
+        held = 0;
+        state.store((((current >> 1) + 1) << 1) | (pessimistic ? 0 : 1), std::memory_order_seq_cst);
+    }
+}
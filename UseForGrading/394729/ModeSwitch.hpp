@@ -0,0 +1,63 @@
+#ifndef MODE_SWITCH_H
+#define MODE_SWITCH_H
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+
+#include "ThreadRegistry.hpp"
+#include "Transaction.hpp"
+
+// Switches a region between the optimistic engine and a pessimistic mode in
+// which transactions run in place under one global reader-writer lock.
+// Threads report their commits and aborts in batches (as for StripeSizer);
+// every window of commits:
+//  - optimistic: as many aborts as commits enter the pessimistic mode;
+//  - pessimistic: once the hold (in windows) has elapsed, the optimistic
+//    mode is tried again. If the first window back still aborts that much,
+//    the region falls back at once with twice the hold; a calm one resets it.
+// Every switch starts a new generation. Transactions register the generation
+// they run in, and the first ones of a new generation wait for those of the
+// older ones to end: the two modes never overlap.
+class ModeSwitch {
+private:
+    static constexpr uint64_t idle = UINT64_MAX;
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> generation{idle}; // Of the running transaction, idle if none
+    };
+
+    bool enabled;
+    std::atomic<uint64_t> state{0};   // generation << 1 | pessimistic
+    std::atomic<uint64_t> drained{0}; // Latest generation known to run alone
+    Slot slots[ThreadRegistry::max_threads];
+    std::shared_mutex lock; // Pessimistic mode: shared by readers, exclusive for writers
+
+    std::atomic<uint64_t> commits{0};
+    std::atomic<uint64_t> aborts{0};
+    std::mutex deciding;
+    uint64_t hold;    // Windows to stay pessimistic
+    uint64_t held;    // Windows spent pessimistic so far
+    bool probing;     // First optimistic window after a fallback
+
+    void adapt();
+    void wait_drained(size_t slot, uint64_t generation);
+
+public:
+    explicit ModeSwitch(bool enabled);
+
+    bool is_enabled() const { return enabled; }
+    // Register the slot's transaction, blocking while an older generation
+    // drains; whether it runs pessimistically
+    bool enter(size_t slot);
+    void exit(size_t slot) {
+        if (enabled) slots[slot].generation.store(idle, std::memory_order_release);
+    }
+    std::shared_mutex& get_lock() { return lock; }
+
+    // Add a thread's statistics since its last report
+    void report(const AccessStats& stats);
+};
+
+#endif // MODE_SWITCH_H
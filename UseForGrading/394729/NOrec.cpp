@@ -0,0 +1,81 @@
+#include "NOrec.hpp"
+
+#include <cstring>
+#include <thread>
+
+#include "macros.h"
+
+// Spins on an odd sequence before yielding the processor to the committer
+static constexpr unsigned int spin_yield_period = 64;
+
+static inline void norec_wait(unsigned int spins) {
+    if (spins % spin_yield_period == 0) {
+        std::this_thread::yield();
+    } else {
+        cpu_relax();
+    }
+}
+
+uint64_t NOrec::begin() const {
+    uint64_t snapshot = sequence.load(std::memory_order_acquire);
+    for (unsigned int spins = 1; snapshot & 1; spins++) {
+        norec_wait(spins);
+        snapshot = sequence.load(std::memory_order_acquire);
+    }
+    return snapshot;
+}
+
+uint64_t NOrec::validate(Transaction* transaction) const {
+    for (;;) {
+        uint64_t time = begin();
+        if (!transaction->values_unchanged()) {
+            return invalid;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == time) {
+            return time;
+        }
+    }
+}
+
+bool NOrec::read(Transaction* transaction, const void* source, void* target, size_t size) const {
+    memcpy(target, source, size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    while (sequence.load(std::memory_order_relaxed) != transaction->get_read_version()) {
+        // A writer committed since the snapshot: the values read so far must
+        // still hold, then read again at the new snapshot
+        uint64_t snapshot = validate(transaction);
+        if (snapshot == invalid) {
+            return false;
+        }
+        transaction->set_read_version(snapshot);
+        memcpy(target, source, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+    transaction->log_value(source, target, size);
+    return true;
+}
+
+uint64_t NOrec::begin_serial() {
+    for (;;) {
+        uint64_t snapshot = begin();
+        if (sequence.compare_exchange_weak(snapshot, snapshot + 1, std::memory_order_acq_rel)) {
+            return snapshot;
+        }
+    }
+}
+
+bool NOrec::commit(Transaction* transaction) {
+    uint64_t snapshot = transaction->get_read_version();
+    while (!sequence.compare_exchange_strong(snapshot, snapshot + 1, std::memory_order_acq_rel)) {
+        snapshot = validate(transaction);
+        if (snapshot == invalid) {
+            return false;
+        }
+    }
+    for (const WriteSetEntry& entry : transaction->get_write_set()) {
+        memcpy(entry.address, entry.new_value(), entry.size_to_write);
+    }
+    sequence.store(snapshot + 2, std::memory_order_release);
+    return true;
+}
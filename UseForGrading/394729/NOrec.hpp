@@ -0,0 +1,40 @@
+#ifndef NOREC_H
+#define NOREC_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Transaction.hpp"
+
+// NOrec engine (Dalessandro, Spear, Scott): no per-stripe metadata, one global
+// sequence lock. A writer commits by moving the sequence from even (snapshot)
+// to odd, writing back its buffered write set and moving it to the next even
+// value. Readers log the values they return; whenever the sequence moved
+// since their snapshot, they revalidate by comparing memory with the logged
+// values, so only a real change of a value read aborts a transaction.
+class NOrec {
+private:
+    static constexpr uint64_t invalid = UINT64_MAX;
+
+    alignas(64) std::atomic<uint64_t> sequence{0};
+
+    // Wait for an even sequence, then check the value log against it: the
+    // new snapshot, or invalid if a value read has changed
+    uint64_t validate(Transaction* transaction) const;
+
+public:
+    // Snapshot of a transaction starting now
+    uint64_t begin() const;
+    // Copy a contiguous range to target and log it, revalidating (and
+    // moving the snapshot) while the sequence moves; false to abort
+    bool read(Transaction* transaction, const void* source, void* target, size_t size) const;
+    // Write back the write set under the sequence lock; false to abort
+    bool commit(Transaction* transaction);
+    // Irrevocable transactions hold the sequence lock from begin to end and
+    // work in place: the snapshot before taking it, then release it
+    uint64_t begin_serial();
+    void end_serial(Transaction* transaction) { sequence.store(transaction->get_read_version() + 2, std::memory_order_release); }
+};
+
+#endif // NOREC_H
@@ -0,0 +1,63 @@
+#ifndef POLICY_H
+#define POLICY_H
+
+#include "Config.hpp"
+
+// Engine variants fixed at build time (see the variants target of the
+// Makefile). A variant fixes the engine, the locking mode, the multiversion
+// mode, the clock scheme and the contention policy as compile-time
+// constants: the accessors of SharedMemory, VersionClock and
+// ContentionManager return them, the branches on them fold and the code of
+// the other choices is dropped. The default build fixes nothing and follows
+// Config, i.e. the environment at tm_create.
+
+// Nothing fixed: the placeholders below are never used
+struct RuntimePolicy {
+    static constexpr bool fixed = false;
+    static constexpr Engine engine = Engine::tl2;
+    static constexpr bool eager = false;
+    static constexpr bool multiversion = false;
+    static constexpr ClockScheme clock = ClockScheme::gv1;
+    static constexpr ContentionPolicy contention = ContentionPolicy::suicide;
+};
+
+template <Engine E, bool Eager, bool Multiversion, ClockScheme Clock, ContentionPolicy Contention>
+struct FixedPolicy {
+    static_assert(!(Eager && Multiversion), "in-place writes overwrite the values the history needs");
+    static_assert(E == Engine::tl2 || (!Eager && !Multiversion), "NOrec and RingSTM have no stripes to lock");
+    static_assert(Clock != ClockScheme::tsc, "an invariant TSC can only be checked at run time");
+
+    static constexpr bool fixed = true;
+    static constexpr Engine engine = E;
+    static constexpr bool eager = Eager;
+    static constexpr bool multiversion = Multiversion;
+    static constexpr ClockScheme clock = Clock;
+    static constexpr ContentionPolicy contention = Contention;
+};
+
+#define TM_POLICY_RUNTIME 0
+#define TM_POLICY_TL2     1 // Commit-time locking
+#define TM_POLICY_ETL     2 // Encounter-time locking
+#define TM_POLICY_MV      3 // Commit-time locking with snapshot readers
+#define TM_POLICY_NOREC   4
+#define TM_POLICY_RING    5
+
+#ifndef TM_POLICY
+#define TM_POLICY TM_POLICY_RUNTIME
+#endif
+
+#if TM_POLICY == TM_POLICY_TL2
+using Policy = FixedPolicy<Engine::tl2, false, false, ClockScheme::gv1, ContentionPolicy::suicide>;
+#elif TM_POLICY == TM_POLICY_ETL
+using Policy = FixedPolicy<Engine::tl2, true, false, ClockScheme::gv1, ContentionPolicy::backoff>;
+#elif TM_POLICY == TM_POLICY_MV
+using Policy = FixedPolicy<Engine::tl2, false, true, ClockScheme::gv4, ContentionPolicy::suicide>;
+#elif TM_POLICY == TM_POLICY_NOREC
+using Policy = FixedPolicy<Engine::norec, false, false, ClockScheme::gv1, ContentionPolicy::backoff>;
+#elif TM_POLICY == TM_POLICY_RING
+using Policy = FixedPolicy<Engine::ring, false, false, ClockScheme::gv1, ContentionPolicy::backoff>;
+#else
+using Policy = RuntimePolicy;
+#endif
+
+#endif // POLICY_H
@@ -0,0 +1,16 @@
+#include "ReadSet.hpp"
+
+ReadSet::ReadSet() : last(no_stripe) {
+    for (uint32_t& slot : recent) {
+        slot = no_stripe;
+    }
+}
+
+void ReadSet::clear() {
+    // Only the filter slots of logged stripes can be set, no need to wipe the whole filter
+    for (uint32_t stripe : stripes) {
+        recent[stripe & (filter_size - 1)] = no_stripe;
+    }
+    stripes.clear();
+    last = no_stripe;
+}
@@ -0,0 +1,41 @@
+#ifndef READ_SET_H
+#define READ_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Read set as a contiguous array of 32-bit stripe indices.
+// TL2 only needs to know which stripes were read (validation compares them
+// against the read version), so repeated reads of a stripe are suppressed by
+// a last-stripe check and a small direct-mapped filter of recent stripes.
+class ReadSet {
+private:
+    static constexpr size_t filter_size = 512; // Power of two
+    static constexpr uint32_t no_stripe = UINT32_MAX;
+
+    std::vector<uint32_t> stripes;
+    uint32_t last;
+    uint32_t recent[filter_size];
+
+public:
+    ReadSet();
+
+    using const_iterator = std::vector<uint32_t>::const_iterator;
+    const_iterator begin() const { return stripes.begin(); }
+    const_iterator end() const { return stripes.end(); }
+    size_t size() const { return stripes.size(); }
+
+    void add(uint32_t stripe) {
+        if (stripe == last) return;
+        last = stripe;
+        uint32_t& slot = recent[stripe & (filter_size - 1)];
+        if (slot == stripe) return;
+        slot = stripe;
+        stripes.push_back(stripe);
+    }
+
+    void clear();
+};
+
+#endif // READ_SET_H
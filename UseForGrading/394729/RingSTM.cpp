@@ -0,0 +1,128 @@
+#include "RingSTM.hpp"
+
+#include <cstring>
+#include <thread>
+
+#include "macros.h"
+
+// Spins on a ring entry before yielding the processor to its writer
+static constexpr unsigned int spin_yield_period = 64;
+// Timestamp of an entry whose signature is being rewritten
+static constexpr uint64_t rewriting = UINT64_MAX;
+
+static inline void ring_wait(unsigned int spins) {
+    if (spins % spin_yield_period == 0) {
+        std::this_thread::yield();
+    } else {
+        cpu_relax();
+    }
+}
+
+void RingSTM::wait_completed(uint64_t timestamp) const {
+    const Entry& entry = ring[timestamp % ring_size];
+    for (unsigned int spins = 1; entry.completed.load(std::memory_order_acquire) < timestamp; spins++) {
+        ring_wait(spins);
+    }
+}
+
+uint64_t RingSTM::begin() const {
+    uint64_t start = ring_index.load(std::memory_order_acquire);
+    wait_completed(start);
+    return start;
+}
+
+bool RingSTM::check(Transaction* transaction) const {
+    uint64_t now = ring_index.load(std::memory_order_acquire);
+    uint64_t start = transaction->get_read_version();
+    if (now == start) {
+        return true;
+    }
+    if (now - start >= ring_size) {
+        return false; // The entries we would need are overwritten
+    }
+
+    const Signature& reads = transaction->get_read_signature();
+    for (uint64_t i = now; i > start; i--) {
+        const Entry& entry = ring[i % ring_size];
+        uint64_t timestamp = entry.timestamp.load(std::memory_order_acquire);
+        for (unsigned int spins = 1; timestamp == rewriting || timestamp < i; spins++) {
+            ring_wait(spins); // Taken but not published yet
+            timestamp = entry.timestamp.load(std::memory_order_acquire);
+        }
+        if (timestamp != i) {
+            return false;
+        }
+        // Seqlock-style read of the signature: still ours if the timestamp held
+        bool conflict = reads.intersects(entry.signature);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (conflict || entry.timestamp.load(std::memory_order_relaxed) != i) {
+            return false;
+        }
+    }
+
+    // Values read from now on must include these commits entirely
+    wait_completed(now);
+    transaction->set_read_version(now);
+    return true;
+}
+
+void RingSTM::publish(uint64_t timestamp, const Signature& signature) {
+    Entry& entry = ring[timestamp % ring_size];
+    entry.timestamp.store(rewriting, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < Signature::word_count; i++) {
+        entry.signature[i].store(signature.words[i], std::memory_order_relaxed);
+    }
+    entry.timestamp.store(timestamp, std::memory_order_release);
+}
+
+void RingSTM::complete(uint64_t timestamp) {
+    wait_completed(timestamp - 1);
+    ring[timestamp % ring_size].completed.store(timestamp, std::memory_order_release);
+}
+
+uint64_t RingSTM::acquire(Transaction* transaction, const Signature& signature) {
+    for (;;) {
+        if (!check(transaction)) {
+            return invalid;
+        }
+        uint64_t start = transaction->get_read_version();
+        if (ring_index.compare_exchange_strong(start, start + 1, std::memory_order_acq_rel)) {
+            publish(start + 1, signature);
+            return start + 1;
+        }
+    }
+}
+
+bool RingSTM::commit(Transaction* transaction) {
+    Signature writes;
+    writes.clear();
+    for (const WriteSetEntry& entry : transaction->get_write_set()) {
+        writes.add_range(entry.address, entry.size_to_write, entry.word_size);
+    }
+    uint64_t timestamp = acquire(transaction, writes);
+    if (timestamp == invalid) {
+        return false;
+    }
+    for (const WriteSetEntry& entry : transaction->get_write_set()) {
+        memcpy(entry.address, entry.new_value(), entry.size_to_write);
+    }
+    complete(timestamp);
+    return true;
+}
+
+uint64_t RingSTM::begin_serial() {
+    Signature everything;
+    everything.fill();
+    for (;;) {
+        uint64_t start = begin();
+        if (ring_index.compare_exchange_weak(start, start + 1, std::memory_order_acq_rel)) {
+            publish(start + 1, everything);
+            return start + 1;
+        }
+    }
+}
+
+void RingSTM::end_serial(Transaction* transaction) {
+    complete(transaction->get_read_version());
+}
@@ -0,0 +1,57 @@
+#ifndef RING_STM_H
+#define RING_STM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "Signature.hpp"
+#include "Transaction.hpp"
+
+// RingSTM engine (Spear, Michael, von Praun): no per-word metadata. A
+// writer commits by taking the next timestamp of a global ring and
+// publishing the signature of its write set in that ring entry, then writes
+// back. Entries complete in timestamp order. A transaction keeps the
+// signature of what it read. After each read, it intersects that signature
+// with the entries newer than its start, so validation costs one signature
+// per concurrent commit, whatever the size of the read set. A transaction
+// lagging a whole ring behind aborts.
+class RingSTM {
+private:
+    static constexpr size_t ring_size = 1024;
+
+    struct alignas(64) Entry {
+        std::atomic<uint64_t> timestamp{0}; // Commit published here, the signature is valid while it holds
+        std::atomic<uint64_t> completed{0}; // Latest commit of this entry fully written back
+        std::atomic<uint64_t> signature[Signature::word_count] = {};
+    };
+
+    alignas(64) std::atomic<uint64_t> ring_index{0}; // Latest commit timestamp
+    Entry ring[ring_size];
+
+    // Wait until the commit at 'timestamp' (and thus every older one) is written back
+    void wait_completed(uint64_t timestamp) const;
+    // Take the timestamp after the transaction's start and publish a
+    // signature in its entry, revalidating while others get it first;
+    // invalid if the transaction must abort
+    uint64_t acquire(Transaction* transaction, const Signature& signature);
+    void publish(uint64_t timestamp, const Signature& signature);
+    void complete(uint64_t timestamp);
+
+public:
+    static constexpr uint64_t invalid = UINT64_MAX;
+
+    // Start of a transaction beginning now
+    uint64_t begin() const;
+    // Intersect the read signature with the commits since the start, then
+    // move the start to the latest one; false to abort
+    bool check(Transaction* transaction) const;
+    // Publish the write signature and write back the write set; false to abort
+    bool commit(Transaction* transaction);
+    // Irrevocable transactions publish a full signature at begin, so that
+    // every reader and committer behind them waits or aborts, and work in place
+    uint64_t begin_serial();
+    void end_serial(Transaction* transaction);
+};
+
+#endif // RING_STM_H
@@ -0,0 +1,34 @@
+#include "SegmentDirectory.hpp"
+
+SegmentDirectory::SegmentDirectory(size_t align) : segments(new Segment[max_segments]), word_shift(__builtin_ctzll(align)) {
+}
+
+SegmentDirectory::~SegmentDirectory() {
+    delete[] segments;
+}
+
+void* SegmentDirectory::add(size_t slot, void* base, size_t size, bool colocated, unsigned int stripe_shift) {
+    size_t id;
+    if (slot != ThreadRegistry::no_slot && !free_ids[slot].empty()) {
+        id = free_ids[slot].back();
+        free_ids[slot].pop_back();
+    } else {
+        id = next_id.fetch_add(1, std::memory_order_relaxed);
+        if (id >= max_segments) {
+            next_id.fetch_sub(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+    }
+    // Published to other threads by the commit storing the address
+    segments[id].base = static_cast<char*>(base);
+    segments[id].size = size;
+    segments[id].colocated = colocated ? colocated_flag | uint32_t(id << colocated_word_bits) : 0;
+    segments[id].stripe_shift = stripe_shift;
+    segments[id].live.store(true, std::memory_order_release);
+    return reinterpret_cast<void*>((uintptr_t(id) + 1) << offset_bits);
+}
+
+void SegmentDirectory::remove(size_t slot, const void* address) {
+    segments[id_of(address)].live.store(false, std::memory_order_relaxed);
+    free_ids[slot].push_back(uint32_t(id_of(address)));
+}
@@ -0,0 +1,100 @@
+#ifndef SEGMENT_DIRECTORY_H
+#define SEGMENT_DIRECTORY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ThreadRegistry.hpp"
+#include "VersionedLock.hpp"
+
+// Segment-relative addressing of a shared memory region.
+// The opaque addresses handed to the user are (segment id + 1) << 48 | offset
+// (sizes stay below 2^48, and the address of the first word is never null),
+// so word arithmetic works within a segment. The directory maps an id to its
+// segment in O(1). Ids freed by a slot are reused by that slot first, others
+// come from a shared counter. A segment is live from its allocation until a
+// transaction freeing it commits; committers claim it, so a segment is
+// freed (and its block and id recycled) once.
+//
+// A small segment may be colocated: each word is stored right after its own
+// versioned lock, [lock][word] in 16 bytes, so a validated read touches one
+// cache line. Its stripes are not in the lock table but encoded as
+// colocated_flag | id << colocated_word_bits | word index.
+class SegmentDirectory {
+public:
+    static constexpr unsigned int offset_bits = 48;
+    static constexpr uintptr_t offset_mask = (uintptr_t(1) << offset_bits) - 1;
+    static constexpr size_t max_segments = (size_t(1) << (64 - offset_bits)) - 1;
+
+    static constexpr uint32_t colocated_flag = uint32_t(1) << 31;
+    static constexpr unsigned int colocated_word_bits = 15;
+    static constexpr size_t max_colocated_words = size_t(1) << colocated_word_bits;
+    static constexpr size_t colocated_stride = 16; // Lock and word (up to 8 bytes)
+
+    struct Segment {
+        char* base;
+        size_t size;        // Bytes as seen by the user
+        uint32_t colocated; // Stripe of the first word if colocated, 0 otherwise
+        unsigned int stripe_shift; // Otherwise, 2^stripe_shift bytes share a lock table stripe
+        std::atomic<bool> live{false};
+    };
+
+private:
+    Segment* segments; // Indexed by id, only entries handed out are initialized
+    std::atomic<size_t> next_id{0};
+    std::vector<uint32_t> free_ids[ThreadRegistry::max_threads];
+    unsigned int word_shift; // log2(align)
+
+public:
+    explicit SegmentDirectory(size_t align);
+    ~SegmentDirectory();
+    SegmentDirectory(const SegmentDirectory&) = delete;
+    SegmentDirectory& operator=(const SegmentDirectory&) = delete;
+
+    static size_t id_of(const void* address) { return (uintptr_t(address) >> offset_bits) - 1; }
+    static uintptr_t offset_of(const void* address) { return uintptr_t(address) & offset_mask; }
+
+    // Bytes of memory backing a segment of 'size' bytes
+    static size_t footprint(size_t size, size_t align, bool colocated) { return colocated ? size / align * colocated_stride : size; }
+
+    // Register a segment for the given slot (or no_slot), nullptr if the directory is full
+    void* add(size_t slot, void* base, size_t size, bool colocated, unsigned int stripe_shift);
+    // Unregister the segment starting at 'address', its id goes to the slot
+    void remove(size_t slot, const void* address);
+
+    const Segment& get(const void* address) const { return segments[id_of(address)]; }
+    // Whether 'address' is the start of a registered segment that is still live
+    bool is_segment_start(const void* address) const {
+        return uintptr_t(address) >> offset_bits != 0 && id_of(address) < max_segments && id_of(address) < next_id.load(std::memory_order_relaxed) && offset_of(address) == 0
+            && segments[id_of(address)].live.load(std::memory_order_acquire);
+    }
+    // Take a live segment out of the live set, false if another free got it first
+    bool claim(const void* address) { return segments[id_of(address)].live.exchange(false, std::memory_order_acq_rel); }
+    // Give back a claim whose free did not commit
+    void unclaim(const void* address) { segments[id_of(address)].live.store(true, std::memory_order_release); }
+
+    // Memory behind an opaque address
+    char* translate(const void* address) const {
+        const Segment& segment = segments[id_of(address)];
+        if (segment.colocated) {
+            return segment.base + (offset_of(address) >> word_shift) * colocated_stride + sizeof(VersionedLock);
+        }
+        return segment.base + offset_of(address);
+    }
+
+    // Stripe of the word at an opaque address of a colocated segment
+    uint32_t colocated_stripe(const void* address) const {
+        return segments[id_of(address)].colocated + uint32_t(offset_of(address) >> word_shift);
+    }
+
+    // Lock of a colocated stripe
+    VersionedLock* colocated_lock(uint32_t stripe) const {
+        size_t id = (stripe & ~colocated_flag) >> colocated_word_bits;
+        size_t word = stripe & (max_colocated_words - 1);
+        return reinterpret_cast<VersionedLock*>(segments[id].base + word * colocated_stride);
+    }
+};
+
+#endif // SEGMENT_DIRECTORY_H
@@ -0,0 +1,46 @@
+#include "SerialGate.hpp"
+
+#include <thread>
+
+#include "macros.h"
+
+// Spins on the gate before yielding the processor to its holder
+static constexpr unsigned int spin_yield_period = 64;
+
+static inline void gate_wait(unsigned int spins) {
+    if (spins % spin_yield_period == 0) {
+        std::this_thread::yield();
+    } else {
+        cpu_relax();
+    }
+}
+
+void SerialGate::enter(size_t slot) {
+    // Publish, then re-check the token: an acquire that missed our store
+    // cannot have finished draining before we back off
+    for (unsigned int spins = 1;; spins++) {
+        slots[slot].inside.store(true, std::memory_order_seq_cst);
+        if (owner.load(std::memory_order_seq_cst) == no_owner) {
+            return;
+        }
+        slots[slot].inside.store(false, std::memory_order_release);
+        while (owner.load(std::memory_order_acquire) != no_owner) {
+            gate_wait(spins++);
+        }
+    }
+}
+
+void SerialGate::acquire(size_t slot) {
+    size_t expected = no_owner;
+    for (unsigned int spins = 1; !owner.compare_exchange_weak(expected, slot, std::memory_order_seq_cst); spins++) {
+        expected = no_owner;
+        gate_wait(spins);
+    }
+
+    size_t slot_count = ThreadRegistry::high_water();
+    for (size_t other = 0; other < slot_count; other++) {
+        for (unsigned int spins = 1; other != slot && slots[other].inside.load(std::memory_order_seq_cst); spins++) {
+            gate_wait(spins);
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef SERIAL_GATE_H
+#define SERIAL_GATE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include "ThreadRegistry.hpp"
+
+// Admission of read-write transactions around an irrevocable one.
+// Every read-write transaction passes the gate at tm_begin and leaves it when
+// it commits or aborts. An irrevocable transaction takes the gate's token:
+// new writers wait at the gate, and the token holder waits for the writers
+// already inside to drain, after which it runs alone among writers.
+// Read-only transactions never pass the gate.
+class SerialGate {
+private:
+    static constexpr size_t no_owner = SIZE_MAX;
+
+    struct alignas(64) Slot {
+        std::atomic<bool> inside{false}; // A read-write transaction of the slot is running
+    };
+
+    std::atomic<size_t> owner{no_owner}; // Slot of the irrevocable transaction, no_owner if none
+    Slot slots[ThreadRegistry::max_threads];
+
+public:
+    // Writer side, blocks while an irrevocable transaction runs
+    void enter(size_t slot);
+    void exit(size_t slot) { slots[slot].inside.store(false, std::memory_order_release); }
+
+    // Irrevocable side: take the token, then wait for the writers inside
+    void acquire(size_t slot);
+    void release() { owner.store(no_owner, std::memory_order_release); }
+};
+
+#endif // SERIAL_GATE_H
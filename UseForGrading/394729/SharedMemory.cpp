@@ -3,44 +3,42 @@
 #include <cstring>
 #include <stdexcept>
 
-SharedMemory::SharedMemory(size_t size, size_t align) : size(size), align(align), version_clock(0) {
-    start = aligned_alloc(align, size);
+SharedMemory::SharedMemory(size_t size, size_t align, const Config& config)
+    : size(size), align(align), colocate_max(config.colocate_max), directory(align), allocator(align), epochs(&SharedMemory::reclaim_segment, this),
+      stripe_sizer(__builtin_ctzll(align), __builtin_ctzll(align * config.stripe_words), config.adaptive_stripes), locks(config.lock_count), history(nullptr), extension(config.extension), eager(config.eager),
+      // Lazy clocks let a commit stay ahead of the clock until a reader catches up, so a
+      // snapshot reader starting after that commit could miss it: use GV4 with history
+      version_clock(config.multiversion && (config.clock == ClockScheme::gv5 || config.clock == ClockScheme::gv6) ? ClockScheme::gv4 : config.clock),
+      contention(config.contention), irrevocable_after(config.irrevocable_after), mode(config.fallback), engine(config.engine), ring(nullptr) {
+    bool colocated = size <= colocate_max;
+    size_t footprint = SegmentDirectory::footprint(size, align, colocated);
+    start = aligned_alloc(colocated ? SegmentDirectory::colocated_stride : align, footprint);
     if (!start) {
         throw std::runtime_error("Failed to allocate shared memory.");
     }
 
-    // Initialize the first segment with zeroes
-    std::memset(start, 0, size);
-
-    // Lock segment list mutex then add the first segment, then unlock
-    Segment* segment = new Segment{start, size};
-    segmentListMutex.lock();
-    segments.push_back(segment);
-    segmentListMutex.unlock();
-
-    for (VersionedLock*& lock : locks) {
-        lock = new VersionedLock();
+    if (config.multiversion) {
+        history = new VersionHistory(locks.size(), align);
     }
+    if (config.engine == Engine::ring) {
+        ring = new RingSTM();
+    }
+
+    // Initialize the first segment with zeroes
+    std::memset(start, 0, footprint);
+    start_address = directory.add(ThreadRegistry::no_slot, start, size, colocated, stripe_sizer.current());
 }
 
 SharedMemory::~SharedMemory() {
+    // The allocator unmaps the segments allocated by transactions
+    free(start);
 
-    // Iterate over all segments and free in a thread-safe manner
-    segmentListMutex.lock();
-    for (Segment* segment : segments) {
-        free(segment->start);
-        free(segment);
-    }
-    segmentListMutex.unlock();
-
-    // Delete all locks
-    for (VersionedLock* lock : locks) {
-        delete lock;
-    }
+    delete history;
+    delete ring;
 }
 
 void* SharedMemory::get_start() const {
-    return start;
+    return start_address;
 }
 
 size_t SharedMemory::get_size() const {
@@ -51,22 +49,24 @@ size_t SharedMemory::get_align() const {
     return align;
 }
 
-// Get the lock for the given address
-VersionedLock* SharedMemory::get_lock(const void* address) {
-    return locks[uint64_t(address) % 10000];
+void* SharedMemory::allocate_segment(size_t slot, size_t size) {
+    bool colocated = size <= colocate_max;
+    void* block = allocator.allocate(slot, SegmentDirectory::footprint(size, align, colocated));
+    if (!block) {
+        return nullptr;
+    }
+    void* address = directory.add(slot, block, size, colocated, stripe_sizer.current());
+    if (!address) {
+        allocator.release(slot, block);
+    }
+    return address;
 }
 
-uint64_t SharedMemory::increment_version_clock() {
-    return version_clock.fetch_add(1) + 1;
+void SharedMemory::release_segment(size_t slot, void* address) {
+    allocator.release(slot, directory.get(address).base);
+    directory.remove(slot, address);
 }
 
-uint64_t SharedMemory::get_version_clock() const {
-    return version_clock.load();
+void SharedMemory::reclaim_segment(void* shared_mem, size_t slot, void* address) {
+    static_cast<SharedMemory*>(shared_mem)->release_segment(slot, address);
 }
-
-void SharedMemory::add_segment(void* start, size_t size) {
-    Segment* new_segment = new Segment{start, size};
-    segmentListMutex.lock();
-    segments.push_back(new_segment);
-    segmentListMutex.unlock();
-}
\ No newline at end of file
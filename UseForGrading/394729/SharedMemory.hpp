@@ -2,49 +2,130 @@
 #define SHARED_MEMORY_H
 
 #include <vector>
-#include <array>
+#include <atomic>
 #include <cstddef>
 #include <mutex>
+#include "Config.hpp"
+#include "ContentionManager.hpp"
+#include "EpochManager.hpp"
+#include "LockTable.hpp"
+#include "ModeSwitch.hpp"
+#include "NOrec.hpp"
+#include "Policy.hpp"
+#include "RingSTM.hpp"
+#include "SegmentDirectory.hpp"
+#include "SerialGate.hpp"
+#include "SlabAllocator.hpp"
+#include "StripeSizer.hpp"
+#include "VersionClock.hpp"
+#include "VersionHistory.hpp"
 #include "VersionedLock.hpp"
 
-class Segment {
-public:
-    void* start;
-    size_t size;
+// Words of one tm_read/tm_write call: the i-th word lives at first + i * stride
+struct WordRange {
+    char* first;
+    size_t stride;
+    uint32_t colocated; // Stripe of the first word if colocated, 0 otherwise
+    unsigned int stripe_shift; // Otherwise, 2^stripe_shift bytes share a stripe
 };
 
-
 class SharedMemory {
 private:   
-    void* start;
+    void* start;         // Memory of the first segment
+    void* start_address; // Its opaque address
     size_t size;
     size_t align;
+    size_t colocate_max;
+
+    // Segments allocated by transactions
+    SegmentDirectory directory;
+    SlabAllocator allocator;
+    EpochManager epochs; // Defers their reuse after tm_free
+    StripeSizer stripe_sizer;
 
-    // Keep track of allocated segments
-    std::vector<Segment*> segments;
+    static void reclaim_segment(void* shared_mem, size_t slot, void* address);
 
-    std::array<VersionedLock*, 10000> locks;
-    std::atomic<uint64_t> version_clock;
+    LockTable locks;
+    VersionHistory* history; // nullptr unless the multiversion mode is enabled
+    bool extension;
+    bool eager;
+    VersionClock version_clock;
+    ContentionManager contention;
+    SerialGate gate; // Quiesces the writers around an irrevocable transaction
+    size_t irrevocable_after;
+    std::atomic<uint64_t> invalid_frees{0}; // Ignored by irrevocable transactions
+    ModeSwitch mode; // Optimistic or global-lock mode
+    Engine engine;
+    NOrec norec; // Sequence lock of the NOrec engine
+    RingSTM* ring; // Ring of the RingSTM engine, nullptr for the others
     std::mutex global_lock;
 
 public:
 
-    SharedMemory(size_t size, size_t align);
+    SharedMemory(size_t size, size_t align, const Config& config);
     ~SharedMemory();
 
     void* get_start() const;
     size_t get_size() const;
     size_t get_align() const;
 
-    VersionedLock* get_lock(const void* index);
-    uint64_t increment_version_clock();
-    uint64_t get_version_clock() const;
+    // Stripe of the i-th word of a range
+    uint32_t get_stripe(const WordRange& range, size_t i) const {
+        return range.colocated ? range.colocated + uint32_t(i) : uint32_t(locks.stripe_of(range.first + i * range.stride, range.stripe_shift));
+    }
+    // End (exclusive, at most 'count') of the run of words from the i-th one sharing its stripe
+    size_t stripe_run_end(const WordRange& range, size_t i, size_t count) const {
+        if (range.colocated) {
+            return i + 1;
+        }
+        uintptr_t address = uintptr_t(range.first + i * range.stride);
+        uintptr_t stripe_end = ((address >> range.stripe_shift) + 1) << range.stripe_shift;
+        size_t end = i + (stripe_end - address) / range.stride;
+        return end < count ? end : count;
+    }
+    LockTable& get_locks() { return locks; }
+    VersionedLock* get_lock_at(uint32_t stripe) {
+        if (stripe & SegmentDirectory::colocated_flag) {
+            return directory.colocated_lock(stripe);
+        }
+        return locks.get(size_t(stripe));
+    }
+    // Constants in a policy variant build (see Policy.hpp)
+    VersionHistory* get_history() const { return Policy::fixed && !Policy::multiversion ? nullptr : history; }
+    bool extension_enabled() const { return extension; }
+    bool eager_locking() const { return Policy::fixed ? Policy::eager : eager; }
+    VersionClock& get_clock() { return version_clock; }
+    uint64_t get_version_clock() const { return version_clock.read(); }
+    ContentionManager& get_contention() { return contention; }
+    SerialGate& get_gate() { return gate; }
+    size_t get_irrevocable_after() const { return irrevocable_after; }
+    void count_invalid_free() { invalid_frees.fetch_add(1, std::memory_order_relaxed); }
+    uint64_t get_invalid_frees() const { return invalid_frees.load(std::memory_order_relaxed); }
+    ModeSwitch& get_mode() { return mode; }
+    Engine get_engine() const { return Policy::fixed ? Policy::engine : engine; }
+    NOrec& get_norec() { return norec; }
+    RingSTM* get_ring() { return ring; }
 
-    // addr = Address to stop unlocking at, set NULL if entire write set should be unlocked
-    void unlock_set(void* addr);
+    // Memory behind the words starting at an opaque address
+    WordRange translate(const void* address) const {
+        const SegmentDirectory::Segment& segment = directory.get(address);
+        if (segment.colocated) {
+            return {directory.translate(address), SegmentDirectory::colocated_stride, directory.colocated_stripe(address), 0};
+        }
+        return {directory.translate(address), align, 0, segment.stripe_shift};
+    }
+    // Whether 'address' is the opaque address of a live segment allocated by a transaction
+    bool is_allocated_segment(const void* address) const { return address != start_address && directory.is_segment_start(address); }
+    // Claim a segment for the free of a committing transaction, false if it was freed already
+    bool claim_segment(const void* address) { return directory.claim(address); }
+    void unclaim_segment(const void* address) { directory.unclaim(address); }
+    // New zeroed segment for the thread of the given slot, its opaque address (nullptr when out of memory)
+    void* allocate_segment(size_t slot, size_t size);
+    // Give a segment back, no transaction may still access it
+    void release_segment(size_t slot, void* address);
 
-    std::mutex segmentListMutex;
-    void add_segment(void* start, size_t size);
+    EpochManager& get_epochs() { return epochs; }
+    StripeSizer& get_stripe_sizer() { return stripe_sizer; }
 };
 
 #endif // SHARED_MEMORY_H
@@ -0,0 +1,50 @@
+#ifndef SIGNATURE_H
+#define SIGNATURE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Fixed-size Bloom filter over word addresses (one hashed bit per word).
+// Intersections may report false conflicts, never miss a real one.
+struct Signature {
+    static constexpr size_t bit_count = 1024;
+    static constexpr size_t word_count = bit_count / 64;
+
+    uint64_t words[word_count];
+
+    static size_t bit_of(const void* address) {
+        return (uint64_t(address) * UINT64_C(0x9E3779B97F4A7C15)) >> (64 - 10);
+    }
+
+    void clear() { memset(words, 0, sizeof(words)); }
+    void fill() { memset(words, 0xFF, sizeof(words)); }
+    bool empty() const {
+        for (uint64_t word : words) {
+            if (word) return false;
+        }
+        return true;
+    }
+    void add(const void* address) {
+        size_t bit = bit_of(address);
+        words[bit / 64] |= uint64_t(1) << (bit % 64);
+    }
+    // Add the words of a contiguous range
+    void add_range(const void* address, size_t size, size_t align) {
+        for (size_t offset = 0; offset < size; offset += align) {
+            add(static_cast<const char*>(address) + offset);
+        }
+    }
+    // Whether the filter shares a bit with a published one (read concurrently with its writer)
+    bool intersects(const std::atomic<uint64_t>* other) const {
+        for (size_t i = 0; i < word_count; i++) {
+            if (words[i] & other[i].load(std::memory_order_relaxed)) return true;
+        }
+        return false;
+    }
+};
+
+static_assert(Signature::bit_count == size_t(1) << 10, "bit_of hashes to 10 bits");
+
+#endif // SIGNATURE_H
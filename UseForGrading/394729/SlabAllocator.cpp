@@ -0,0 +1,147 @@
+#include "SlabAllocator.hpp"
+#include <cstring>
+#include <sys/mman.h>
+
+static constexpr size_t page_size = 4096;
+
+static size_t round_up(size_t value, size_t multiple) {
+    return (value + multiple - 1) & ~(multiple - 1);
+}
+
+SlabAllocator::SlabAllocator(size_t align)
+    : align(align), min_class_shift(__builtin_ctzll(align)),
+      data_offset(round_up(sizeof(ChunkHeader), align > 64 ? align : 64)) {
+}
+
+SlabAllocator::~SlabAllocator() {
+    ChunkHeader* chunk = mappings.load(std::memory_order_acquire);
+    while (chunk) {
+        ChunkHeader* next = chunk->next;
+        munmap(chunk, chunk->mapping_size);
+        chunk = next;
+    }
+    for (ThreadCache* cache : caches) {
+        delete cache;
+    }
+}
+
+SlabAllocator::ChunkHeader* SlabAllocator::map(size_t mapping_size, size_t class_size) {
+    // Over-map by one chunk and trim to get a chunk_size-aligned mapping
+    mapping_size = round_up(mapping_size, chunk_size);
+    size_t raw_size = mapping_size + chunk_size;
+    void* raw = mmap(nullptr, raw_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        return nullptr;
+    }
+    uintptr_t base = round_up(uintptr_t(raw), chunk_size);
+    size_t head = base - uintptr_t(raw);
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    if (raw_size - head > mapping_size) {
+        munmap(reinterpret_cast<void*>(base + mapping_size), raw_size - head - mapping_size);
+    }
+
+    ChunkHeader* chunk = reinterpret_cast<ChunkHeader*>(base);
+    chunk->mapping_size = mapping_size;
+    chunk->class_size = class_size;
+    chunk->next_free = nullptr;
+    ChunkHeader* head_chunk = mappings.load(std::memory_order_relaxed);
+    do {
+        chunk->next = head_chunk;
+    } while (!mappings.compare_exchange_weak(head_chunk, chunk, std::memory_order_release, std::memory_order_relaxed));
+    return chunk;
+}
+
+SlabAllocator::ThreadCache* SlabAllocator::cache_of(size_t slot) {
+    // A slot is used by one thread at a time, no synchronization needed
+    ThreadCache* cache = caches[slot];
+    if (!cache) {
+        cache = new ThreadCache();
+        caches[slot] = cache;
+    }
+    return cache;
+}
+
+unsigned int SlabAllocator::class_of(size_t size) const {
+    unsigned int shift = size <= align ? min_class_shift : 64 - __builtin_clzll(size - 1);
+    return shift - min_class_shift;
+}
+
+void* SlabAllocator::allocate(size_t slot, size_t size) {
+    if (size > max_class_size || align > max_class_size) {
+        return allocate_large(size);
+    }
+
+    unsigned int index = class_of(size);
+    size_t class_size = size_t(1) << (index + min_class_shift);
+    SizeClass& size_class = cache_of(slot)->classes[index];
+
+    if (size_class.free_list) {
+        FreeBlock* block = size_class.free_list;
+        size_class.free_list = block->next;
+        memset(block, 0, size);
+        return block;
+    }
+    if (size_t(size_class.end - size_class.bump) < class_size) {
+        ChunkHeader* chunk = map(chunk_size, class_size);
+        if (!chunk) {
+            return nullptr;
+        }
+        size_class.bump = reinterpret_cast<char*>(chunk) + data_offset;
+        size_class.end = reinterpret_cast<char*>(chunk) + chunk_size;
+    }
+    void* block = size_class.bump;
+    size_class.bump += class_size;
+    return block;
+}
+
+void SlabAllocator::release(size_t slot, void* block) {
+    ChunkHeader* chunk = reinterpret_cast<ChunkHeader*>(uintptr_t(block) & ~(chunk_size - 1));
+    if (chunk->class_size == 0) {
+        release_large(chunk, block);
+        return;
+    }
+    FreeBlock* free_block = static_cast<FreeBlock*>(block);
+    SizeClass& size_class = cache_of(slot)->classes[class_of(chunk->class_size)];
+    free_block->next = size_class.free_list;
+    size_class.free_list = free_block;
+}
+
+// Smallest released mapping that fits, a new one otherwise
+void* SlabAllocator::allocate_large(size_t size) {
+    size_t mapping_size = round_up(data_offset + size, chunk_size);
+    {
+        std::lock_guard<std::mutex> guard(large_lock);
+        for (ChunkHeader** link = &large_free; *link; link = &(*link)->next_free) {
+            ChunkHeader* chunk = *link;
+            if (chunk->mapping_size >= mapping_size) {
+                *link = chunk->next_free;
+                // The pages after the first were dropped and come back zeroed
+                char* block = reinterpret_cast<char*>(chunk) + data_offset;
+                size_t head = page_size - data_offset % page_size;
+                memset(block, 0, size < head ? size : head);
+                return block;
+            }
+        }
+    }
+    ChunkHeader* chunk = map(mapping_size, 0);
+    return chunk ? reinterpret_cast<char*>(chunk) + data_offset : nullptr;
+}
+
+// The mapping stays registered (the registry is append-only): drop its pages
+// and keep it for a later large request
+void SlabAllocator::release_large(ChunkHeader* chunk, void* block) {
+    uintptr_t first_page = round_up(uintptr_t(block), page_size);
+    uintptr_t end = uintptr_t(chunk) + chunk->mapping_size;
+    if (first_page < end) {
+        madvise(reinterpret_cast<void*>(first_page), end - first_page, MADV_DONTNEED);
+    }
+    std::lock_guard<std::mutex> guard(large_lock);
+    ChunkHeader** link = &large_free;
+    while (*link && (*link)->mapping_size < chunk->mapping_size) {
+        link = &(*link)->next_free;
+    }
+    chunk->next_free = *link;
+    *link = chunk;
+}
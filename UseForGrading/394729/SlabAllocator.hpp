@@ -0,0 +1,76 @@
+#ifndef SLAB_ALLOCATOR_H
+#define SLAB_ALLOCATOR_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+#include "ThreadRegistry.hpp"
+
+// Segment allocator of a shared memory region.
+// Requests up to max_class_size are rounded up to a power-of-two size class
+// and served from per-thread caches (indexed by thread slot): a free list of
+// recycled blocks, then a bump pointer into a chunk owned by that thread and
+// class. Chunks are chunk_size-aligned anonymous mappings, so a block finds
+// its chunk header by masking its address, and fresh blocks come zeroed from
+// the kernel: only recycled blocks are cleared. Larger requests get their own
+// mapping; a released one drops its pages and waits on a shared free list for
+// the next large request it can hold. Every mapping is pushed onto a
+// lock-free list and unmapped when the region is destroyed.
+class SlabAllocator {
+public:
+    static constexpr size_t chunk_size = size_t(1) << 21;
+    static constexpr size_t max_class_size = size_t(1) << 18;
+
+private:
+    struct ChunkHeader {
+        ChunkHeader* next; // Registry link
+        size_t mapping_size;
+        size_t class_size; // 0 for a dedicated (large) mapping
+        ChunkHeader* next_free; // Large free list link
+    };
+
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct SizeClass {
+        char* bump;
+        char* end;
+        FreeBlock* free_list;
+    };
+
+    struct ThreadCache {
+        SizeClass classes[64];
+    };
+
+    size_t align;
+    unsigned int min_class_shift; // log2 of the smallest class (the alignment)
+    size_t data_offset;           // Start of the blocks in a mapping, after the header
+    std::atomic<ChunkHeader*> mappings{nullptr};
+    ThreadCache* caches[ThreadRegistry::max_threads] = {};
+    std::mutex large_lock;         // Large requests map memory anyway, a lock is cheap next to it
+    ChunkHeader* large_free = nullptr; // Released large mappings, by increasing size
+
+    void* allocate_large(size_t size);
+    void release_large(ChunkHeader* chunk, void* block);
+
+    ChunkHeader* map(size_t mapping_size, size_t class_size);
+    ThreadCache* cache_of(size_t slot);
+    unsigned int class_of(size_t size) const;
+
+public:
+    explicit SlabAllocator(size_t align);
+    ~SlabAllocator();
+    SlabAllocator(const SlabAllocator&) = delete;
+    SlabAllocator& operator=(const SlabAllocator&) = delete;
+
+    // Zeroed block of at least 'size' bytes for the thread of the given slot, nullptr when out of memory
+    void* allocate(size_t slot, size_t size);
+    // Recycle a block into the cache of the given slot (a large block's pages
+    // are returned to the kernel and its mapping kept for reuse)
+    void release(size_t slot, void* block);
+};
+
+#endif // SLAB_ALLOCATOR_H
@@ -0,0 +1,40 @@
+#include "StripeSizer.hpp"
+
+// Commits between two decisions
+static constexpr uint64_t window = 4096;
+// Coarsest adaptive stripe, relative to the configured one
+static constexpr unsigned int max_coarsening = 3;
+// Mostly read: at least this many reads per write
+static constexpr uint64_t read_write_ratio = 16;
+
+StripeSizer::StripeSizer(unsigned int min_shift, unsigned int shift, bool adaptive)
+    : min_shift(min_shift), max_shift(shift + max_coarsening), adaptive(adaptive), shift(shift) {
+}
+
+void StripeSizer::report(const AccessStats& stats) {
+    reads.fetch_add(stats.reads, std::memory_order_relaxed);
+    writes.fetch_add(stats.writes, std::memory_order_relaxed);
+    aborts.fetch_add(stats.aborts, std::memory_order_relaxed);
+    uint64_t before = commits.fetch_add(stats.commits, std::memory_order_relaxed);
+    // The report crossing the window decides
+    if (before < window && before + stats.commits >= window) {
+        adapt();
+    }
+}
+
+void StripeSizer::adapt() {
+    uint64_t window_reads = reads.exchange(0, std::memory_order_relaxed);
+    uint64_t window_writes = writes.exchange(0, std::memory_order_relaxed);
+    uint64_t window_aborts = aborts.exchange(0, std::memory_order_relaxed);
+    uint64_t window_commits = commits.exchange(0, std::memory_order_relaxed);
+
+    unsigned int current = shift.load(std::memory_order_relaxed);
+    if (window_aborts * 8 > window_commits) {
+        // More than one abort per 8 commits: split stripes
+        if (current > min_shift) current--;
+    } else if (window_reads >= window_writes * read_write_ratio && window_aborts * 64 < window_commits) {
+        // Mostly read and hardly any conflict: coarsen stripes
+        if (current < max_shift) current++;
+    }
+    shift.store(current, std::memory_order_relaxed);
+}
@@ -0,0 +1,44 @@
+#ifndef STRIPE_SIZER_H
+#define STRIPE_SIZER_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "Transaction.hpp"
+
+// Chooses the stripe size (log2 of the bytes covered by one lock) of new
+// segments. Fixed at the region's configured size, or adaptive: threads
+// report their reads, writes, commits and aborts in batches, and every
+// window of commits the size for the next segments is coarsened when the
+// region is mostly read with few aborts (fewer lock checks per multi-word
+// access), or refined when aborts are frequent (fewer false conflicts).
+// A live segment keeps its stripe size: transactions log stripe numbers,
+// so re-striping it would hide conflicts from them.
+// Limitation: the statistics are region-wide and every abort counts, so the
+// size does not follow the access pattern of a single segment, and a real
+// conflict refines the stripes just like a false one.
+class StripeSizer {
+private:
+    unsigned int min_shift; // One word per stripe
+    unsigned int max_shift;
+    bool adaptive;
+    std::atomic<unsigned int> shift;
+
+    std::atomic<uint64_t> reads{0};
+    std::atomic<uint64_t> writes{0};
+    std::atomic<uint64_t> commits{0};
+    std::atomic<uint64_t> aborts{0};
+
+    void adapt();
+
+public:
+    StripeSizer(unsigned int min_shift, unsigned int shift, bool adaptive);
+
+    bool is_adaptive() const { return adaptive; }
+    // Stripe size of a segment allocated now
+    unsigned int current() const { return shift.load(std::memory_order_relaxed); }
+    // Add a thread's statistics since its last report
+    void report(const AccessStats& stats);
+};
+
+#endif // STRIPE_SIZER_H
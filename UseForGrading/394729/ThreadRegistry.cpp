@@ -0,0 +1,54 @@
+#include "ThreadRegistry.hpp"
+#include <atomic>
+
+namespace {
+
+std::atomic<bool> slot_used[ThreadRegistry::max_threads];
+std::atomic<Transaction*> slot_transaction[ThreadRegistry::max_threads];
+std::atomic<size_t> slot_high_water{0};
+
+// Releases the slot of a thread when it exits
+struct SlotHandle {
+    size_t slot = ThreadRegistry::no_slot;
+
+    ~SlotHandle() {
+        if (slot != ThreadRegistry::no_slot) {
+            slot_used[slot].store(false, std::memory_order_release);
+        }
+    }
+};
+
+thread_local SlotHandle handle;
+
+size_t claim_slot() {
+    for (size_t slot = 0; slot < ThreadRegistry::max_threads; slot++) {
+        bool expected = false;
+        if (!slot_used[slot].load(std::memory_order_relaxed) && slot_used[slot].compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            // First owner of the slot creates the context, later owners reuse it
+            if (!slot_transaction[slot].load(std::memory_order_relaxed)) {
+                slot_transaction[slot].store(new Transaction(slot), std::memory_order_release);
+            }
+            size_t high = slot_high_water.load(std::memory_order_relaxed);
+            while (high <= slot && !slot_high_water.compare_exchange_weak(high, slot + 1)) {}
+            return slot;
+        }
+    }
+    return ThreadRegistry::no_slot;
+}
+
+} // namespace
+
+size_t ThreadRegistry::current_slot() {
+    if (handle.slot == no_slot) {
+        handle.slot = claim_slot();
+    }
+    return handle.slot;
+}
+
+Transaction* ThreadRegistry::get(size_t slot) {
+    return slot_transaction[slot].load(std::memory_order_acquire);
+}
+
+size_t ThreadRegistry::high_water() {
+    return slot_high_water.load(std::memory_order_acquire);
+}
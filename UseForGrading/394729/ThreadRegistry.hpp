@@ -0,0 +1,25 @@
+#ifndef THREAD_REGISTRY_H
+#define THREAD_REGISTRY_H
+
+#include <cstddef>
+#include "Transaction.hpp"
+
+// Process-wide table of per-thread transaction contexts.
+// A thread claims a slot on its first transaction and gives it back when it
+// exits; the Transaction stored in the slot (and its warmed-up logs) is kept
+// for the next thread claiming the same slot. The opaque tx_t handed out by
+// tm_begin is the slot index.
+class ThreadRegistry {
+public:
+    static constexpr size_t max_threads = 1024;
+    static constexpr size_t no_slot = size_t(-1);
+
+    // Slot of the calling thread, claimed on first use, no_slot if the table is full
+    static size_t current_slot();
+    // Transaction context of the given slot
+    static Transaction* get(size_t slot);
+    // Upper bound (exclusive) of the slots ever claimed
+    static size_t high_water();
+};
+
+#endif // THREAD_REGISTRY_H
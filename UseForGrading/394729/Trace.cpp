@@ -0,0 +1,94 @@
+#include "Trace.hpp"
+
+#ifdef TM_TRACE
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <new>
+#include "ThreadRegistry.hpp"
+#include "Tsc.hpp"
+
+namespace {
+
+// Events kept per slot (power of 2)
+constexpr size_t ring_events = size_t(1) << 14;
+
+// Written by the thread owning the slot only: the head is published with a
+// release store so that a flush sees the events below it
+struct Ring {
+    std::atomic<uint64_t> head{0};
+    Trace::Event events[ring_events];
+};
+
+std::atomic<Ring*> rings[ThreadRegistry::max_threads];
+std::mutex flush_lock;
+uint32_t flushes = 0;
+
+inline uint64_t now() {
+#if defined(__x86_64__)
+    return Tsc::read();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+} // namespace
+
+void Trace::record(size_t slot, Kind kind, uint16_t flags, uint64_t a, uint64_t b) {
+    if (slot >= ThreadRegistry::max_threads) {
+        return;
+    }
+    Ring* ring = rings[slot].load(std::memory_order_acquire);
+    if (!ring) {
+        // First event of the slot; dropped if the buffer cannot be allocated
+        ring = new (std::nothrow) Ring;
+        if (!ring) {
+            return;
+        }
+        rings[slot].store(ring, std::memory_order_release);
+    }
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    ring->events[head & (ring_events - 1)] = Event{now(), static_cast<uint32_t>(slot), static_cast<uint16_t>(kind), flags, a, b};
+    ring->head.store(head + 1, std::memory_order_release);
+}
+
+// Called with no running transaction: the rings are emptied after being written
+void Trace::flush() {
+    std::lock_guard<std::mutex> guard(flush_lock);
+    const char* path = std::getenv("TM_TRACE_FILE");
+    std::ofstream file(path ? path : "tm.trace", std::ios::binary | std::ios::app);
+    if (!file) {
+        return;
+    }
+    file.seekp(0, std::ios::end);
+    if (file.tellp() == 0) {
+        FileHeader header{{}, sizeof(Event), ring_events};
+        std::copy(std::begin(file_magic), std::end(file_magic), header.magic);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    for (size_t slot = 0; slot < ThreadRegistry::high_water(); slot++) {
+        Ring* ring = rings[slot].load(std::memory_order_acquire);
+        if (!ring) {
+            continue;
+        }
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head == 0) {
+            continue;
+        }
+        uint64_t count = head < ring_events ? head : ring_events;
+        RingHeader header{static_cast<uint32_t>(slot), flushes, head - count, count};
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        // Oldest first: from the head around the end of the buffer
+        for (uint64_t i = head - count; i < head; i++) {
+            file.write(reinterpret_cast<const char*>(&ring->events[i & (ring_events - 1)]), sizeof(Event));
+        }
+        ring->head.store(0, std::memory_order_release);
+    }
+    flushes++;
+}
+
+#endif // TM_TRACE
@@ -0,0 +1,80 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Compile-time event tracing.
+// Built with -DTM_TRACE (`make trace`), TM_TRACE_EVENT appends a fixed-size
+// binary event to the ring buffer of the given thread slot: one writer per
+// ring, no lock, the oldest events are overwritten. TM_TRACE_FLUSH appends the
+// rings to the file named by TM_TRACE_FILE (tm.trace by default), which
+// tools/trace_decode prints as timelines. Without TM_TRACE both macros expand
+// to nothing and their arguments are not evaluated.
+namespace Trace {
+
+enum class Kind : uint16_t {
+    create,  // a: size, b: align
+    destroy,
+    begin,   // flags: begin_*, a: read version
+    commit,  // a: write version
+    abort,   // a: consecutive aborts before this one
+    read,    // a: source, b: size
+    write,   // a: target, b: size
+    alloc,   // a: segment, b: size
+    free,    // a: segment
+    invalid_free, // a: target, ignored by an irrevocable transaction
+};
+
+// Flags of a begin event
+constexpr uint16_t begin_read_only = 1;
+constexpr uint16_t begin_irrevocable = 2;
+constexpr uint16_t begin_pessimistic = 4;
+
+struct Event {
+    uint64_t time; // Time-stamp counter (steady clock nanoseconds off x86-64)
+    uint32_t slot;
+    uint16_t kind;
+    uint16_t flags;
+    uint64_t a;
+    uint64_t b;
+};
+static_assert(sizeof(Event) == 32, "trace events are fixed-size records");
+
+// Trace file: a FileHeader, then for every flushed non-empty ring a RingHeader
+// followed by its events, oldest first
+constexpr char file_magic[8] = {'T', 'M', 'T', 'R', 'A', 'C', 'E', '1'};
+
+struct FileHeader {
+    char magic[8];
+    uint32_t event_size;
+    uint32_t ring_events;
+};
+
+struct RingHeader {
+    uint32_t slot;
+    uint32_t flush;    // Index of the flush (one per destroyed region)
+    uint64_t dropped;  // Events overwritten before the flush
+    uint64_t count;    // Events following
+};
+
+#ifdef TM_TRACE
+void record(size_t slot, Kind kind, uint16_t flags, uint64_t a, uint64_t b);
+void flush();
+#endif
+
+} // namespace Trace
+
+#ifdef TM_TRACE
+#define TM_TRACE_EVENT(slot, kind, flags, a, b) \
+    Trace::record((slot), Trace::Kind::kind, (flags), (uint64_t)(a), (uint64_t)(b))
+#define TM_TRACE_FLUSH() \
+    Trace::flush()
+#else
+#define TM_TRACE_EVENT(slot, kind, flags, a, b) \
+    do {} while (0)
+#define TM_TRACE_FLUSH() \
+    do {} while (0)
+#endif
+
+#endif // TRACE_H
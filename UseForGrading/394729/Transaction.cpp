@@ -1,27 +1,63 @@
 #include "Transaction.hpp"
+#include "Trace.hpp"
 
-Transaction::Transaction(uint64_t read_version, bool is_read_only)
-    : read_version(read_version), write_version(0), is_read_only(is_read_only), active(true) {
-    }
+#include <algorithm>
 
-Transaction::~Transaction() {
-    for (auto entry : read_set) {
-        delete entry;
-    }
-    for (auto entry : write_set) {
-        delete entry.second;
+Transaction::Transaction(size_t slot)
+    : slot(slot), read_version(0), write_version(0), is_read_only(true), irrevocable(false), pessimistic(false), active(false), commit_count(0), write_set(&arena), undo_log(&arena), value_log(&arena),
+      consecutive_aborts(0), karma(0), priority(0) {
+        read_signature.clear();
     }
+
+void Transaction::begin(uint64_t read_version, bool is_read_only) {
+    this->read_version = read_version;
+    this->write_version = 0;
+    this->is_read_only = is_read_only;
+    active = true;
 }
-void Transaction::add_read(const void* addr, uint64_t version) {
-    read_set.push_back(new ReadSetEntry{addr, version});
+
+void Transaction::reset() {
+    read_set.clear();
+    write_set.clear();
+    undo_log.clear();
+    value_log.clear();
+    read_signature.clear();
+    arena.reset();
+    write_stripes.clear();
+    allocs.clear();
+    frees.clear();
+    locked.clear();
+    irrevocable = false;
+    pessimistic = false;
+    active = false;
+}
+
+const std::vector<uint32_t>& Transaction::sort_write_stripes() {
+    std::sort(write_stripes.begin(), write_stripes.end());
+    write_stripes.erase(std::unique(write_stripes.begin(), write_stripes.end()), write_stripes.end());
+    return write_stripes;
 }
 
-void Transaction::add_write(void* addr, void* ptr_to_value, uint64_t version, size_t size_to_write) {
-    // Delete the old entry if it exists
-    if (write_set.find(addr) != write_set.end()) {
-        delete write_set[addr];
+void Transaction::add_locked(uint32_t stripe, uint64_t word) {
+    // Commit-time locking takes stripes in order, encounter-time locking does not
+    if (locked.empty() || locked.back().stripe < stripe) {
+        locked.push_back({stripe, word});
+        return;
     }
-    write_set[addr] = new WriteSetEntry{addr, ptr_to_value, version, size_to_write};
+    auto it = std::lower_bound(locked.begin(), locked.end(), stripe,
+                               [](const LockedStripe& locked, uint32_t stripe) { return locked.stripe < stripe; });
+    locked.insert(it, {stripe, word});
+}
+
+const uint64_t* Transaction::find_locked(uint32_t stripe) const {
+    // The log is kept in stripe order
+    auto it = std::lower_bound(locked.begin(), locked.end(), stripe,
+                               [](const LockedStripe& locked, uint32_t stripe) { return locked.stripe < stripe; });
+    return (it != locked.end() && it->stripe == stripe) ? &it->word : nullptr;
+}
+
+void Transaction::add_write(void* addr, uint32_t stripe, const void* value, size_t size_to_write) {
+    write_set.put(addr, stripe, value, size_to_write);
 }
 
 bool Transaction::is_active() const {
@@ -32,17 +68,23 @@ bool Transaction::is_read_only_tx() const {
     return is_read_only;
 }
 
-const std::unordered_map<void*, WriteSetEntry*> Transaction::get_write_set() const {
+const WriteSet& Transaction::get_write_set() const {
     return write_set;
 }
 
-const std::vector<ReadSetEntry*> Transaction::get_read_set() const {
+const ReadSet& Transaction::get_read_set() const {
     return read_set;
 }
 
 void Transaction::commit(uint64_t write_version) {
+    TM_TRACE_EVENT(slot, commit, 0, write_version, 0);
     this->write_version = write_version;
-    active = false;
+    stats.reads += read_set.size();
+    stats.writes += write_set.size() + undo_log.size();
+    stats.commits++;
+    consecutive_aborts = 0;
+    karma = 0;
+    reset();
 }
 
 void Transaction::set_wv(uint64_t wv) {
@@ -54,7 +96,13 @@ uint64_t Transaction::get_wv() {
 }
 
 void Transaction::abort() {
-    active = false;
+    TM_TRACE_EVENT(slot, abort, 0, consecutive_aborts, 0);
+    stats.reads += read_set.size();
+    stats.writes += write_set.size() + undo_log.size();
+    stats.aborts++;
+    consecutive_aborts++;
+    karma += get_work();
+    reset();
 }
 
 uint64_t Transaction::get_read_version() {
@@ -1,44 +1,161 @@
 #ifndef TRANSACTION_H
 #define TRANSACTION_H
 
-#include <unordered_map>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
+#include "Arena.hpp"
+#include "ReadSet.hpp"
+#include "Signature.hpp"
+#include "UndoLog.hpp"
+#include "ValueLog.hpp"
 #include "VersionedLock.hpp"
+#include "WriteSet.hpp"
 
-struct ReadSetEntry {
-    const void* address;      // Address being read
-    uint64_t version;   // Version of the lock at the time of the read
+// Stripe with a lock word: locked at commit time with the word it replaced,
+// or sampled by a read with the word seen
+struct LockedStripe {
+    uint32_t stripe;
+    uint64_t word;
 };
 
-struct WriteSetEntry {
-    const void* address;
-    void* new_value;
-    uint64_t version;
-    size_t size_to_write;
+// Segment allocated by the transaction itself: invisible to others until commit
+struct CapturedSegment {
+    char* start; // Opaque address
+    size_t size;
 };
 
+// Words accessed and transactions ended by a context
+struct AccessStats {
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t commits = 0;
+    uint64_t aborts = 0;
+};
+
+// Transaction context, owned by a thread slot (see ThreadRegistry) and reused
+// across transactions: the logs are reset on commit/abort, never freed.
 class Transaction {
 private:
+    size_t slot; // Thread slot owning this context
     uint64_t read_version;
     uint64_t write_version;
     bool is_read_only;
+    bool irrevocable; // Runs alone among writers and cannot abort
+    bool pessimistic; // Runs in place under the region's global lock (see ModeSwitch)
     bool active;
-    std::vector<ReadSetEntry*> read_set;
-    std::unordered_map<void*, WriteSetEntry*> write_set;
+    uint64_t commit_count; // Writing commits by this context, paces history reclamation
+    Arena arena;
+    ReadSet read_set;
+    WriteSet write_set;
+    UndoLog undo_log; // Encounter-time locking and pessimistic mode: values overwritten in place
+    ValueLog value_log; // NOrec only: values read
+    Signature read_signature; // RingSTM only: words read
+    std::vector<uint32_t> write_stripes; // Stripes covering the write set, gathered at commit
+    std::vector<CapturedSegment> allocs; // Segments allocated, given back on abort
+    std::vector<void*> frees; // Segments freed, retired at commit
+    std::vector<LockedStripe> locked; // Stripes held by the commit in progress, in stripe order
+    std::vector<LockedStripe> samples; // Stripes sampled by the read in progress
+
+    // Contention bookkeeping, kept across the retries of one transaction
+    uint64_t consecutive_aborts;
+    uint64_t karma;                  // Work lost by the aborted attempts
+    std::atomic<uint64_t> priority;  // Published for transactions waiting on our locks
+
+    AccessStats stats; // Not yet reported to the stripe sizer
+
+    void reset();
 
 public:
-    Transaction(uint64_t read_version, bool is_read_only);
-    ~Transaction();
-    void add_read(const void* addr, uint64_t version);
-    void add_write(void* addr, void* value, uint64_t version, size_t size_to_write);
+    explicit Transaction(size_t slot);
+    size_t get_slot() const { return slot; }
+    void begin(uint64_t read_version, bool is_read_only);
+    void add_read(uint32_t stripe) { read_set.add(stripe); }
+    void add_write(void* addr, uint32_t stripe, const void* value, size_t size_to_write);
+    // Log contiguous words as one entry, false if some were written already
+    bool add_write_range(void* addr, const void* value, size_t size, size_t word_size, uint32_t stripe, unsigned int stripe_shift) {
+        return write_set.put_range(addr, value, size, word_size, stripe, stripe_shift);
+    }
+    void add_alloc(void* segment, size_t size) { allocs.push_back({static_cast<char*>(segment), size}); }
+    const std::vector<CapturedSegment>& get_allocs() const { return allocs; }
+    // Whether the range lies in a segment allocated by this transaction, which
+    // no other transaction can access: read and written in place, unlogged
+    bool is_captured(const void* addr, size_t size) const {
+        const char* begin = static_cast<const char*>(addr);
+        for (const CapturedSegment& segment : allocs) {
+            if (begin >= segment.start && begin + size <= segment.start + segment.size) {
+                return true;
+            }
+        }
+        return false;
+    }
+    // False if the transaction already frees the segment
+    bool add_free(void* segment) {
+        if (std::find(frees.begin(), frees.end(), segment) != frees.end()) {
+            return false;
+        }
+        frees.push_back(segment);
+        return true;
+    }
+    const std::vector<void*>& get_frees() const { return frees; }
+    // Encounter-time locking: save the word before writing it in place
+    void save_undo(void* addr, size_t size) { undo_log.save(addr, size); }
+    // Encounter-time locking: put back the words written in place
+    void roll_back() { undo_log.roll_back(); }
+    // NOrec: log the value of a range read, check the logged values against memory
+    void log_value(const void* addr, const void* value, size_t size) { value_log.add(addr, value, size); }
+    bool values_unchanged() const { return value_log.unchanged(); }
+    // RingSTM: words read, as a signature
+    void sign_read(const void* addr, size_t size, size_t align) { read_signature.add_range(addr, size, align); }
+    const Signature& get_read_signature() const { return read_signature; }
+    // Entry of a word written by this transaction, nullptr if none (no copy)
+    const WriteSetEntry* find_write(const void* addr) const { return write_set.find(addr); }
     bool is_active() const;
     bool is_read_only_tx() const;
-    const std::unordered_map<void*, WriteSetEntry*> get_write_set() const;
-    const std::vector<ReadSetEntry*> get_read_set() const;
+    bool is_irrevocable() const { return irrevocable; }
+    void set_irrevocable() { irrevocable = true; }
+    bool is_pessimistic() const { return pessimistic; }
+    void set_pessimistic() { pessimistic = true; }
+    const WriteSet& get_write_set() const;
+    const ReadSet& get_read_set() const;
     uint64_t get_read_version();
+    void set_read_version(uint64_t rv) { read_version = rv; }
     uint64_t get_wv();
     void set_wv(uint64_t wv);
+    uint64_t count_commit() { return ++commit_count; }
+
+    void add_write_stripe(uint32_t stripe) { write_stripes.push_back(stripe); }
+    // Deduplicate and sort the gathered stripes: the global lock acquisition order
+    const std::vector<uint32_t>& sort_write_stripes();
+    // Log a stripe just locked, keeping the log in stripe order
+    void add_locked(uint32_t stripe, uint64_t word);
+    const std::vector<LockedStripe>& get_locked() const { return locked; }
+    void clear_locked() { locked.clear(); }
+    // Word a stripe held before this transaction locked it, nullptr if not locked by it
+    const uint64_t* find_locked(uint32_t stripe) const;
+    // Lock words sampled by one read, re-checked once its words are copied
+    void clear_samples() { samples.clear(); }
+    void add_sample(uint32_t stripe, uint64_t word) { samples.push_back({stripe, word}); }
+    const std::vector<LockedStripe>& get_samples() const { return samples; }
+
+    uint64_t get_aborts() const { return consecutive_aborts; }
+    uint64_t get_karma() const { return karma; }
+    // Work done by the current attempt
+    uint64_t get_work() const { return read_set.size() + write_set.size() + undo_log.size() + value_log.size(); }
+    // Transactions ended (committed or aborted) since the last take_stats
+    uint64_t get_unreported() const { return stats.commits + stats.aborts; }
+    // Statistics since the last call
+    AccessStats take_stats() {
+        AccessStats taken = stats;
+        stats = AccessStats();
+        return taken;
+    }
+    uint64_t get_priority() const { return priority.load(std::memory_order_relaxed); }
+    void publish_priority(uint64_t value) { priority.store(value, std::memory_order_relaxed); }
+
     void commit(uint64_t write_version);
     void abort();
 };
@@ -0,0 +1,150 @@
+#include "Tsc.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) && defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Ping-pong rounds per pair of cores
+constexpr int calibration_rounds = 64;
+
+std::once_flag calibrated;
+uint64_t calibrated_boundary = 0;
+
+#if defined(__x86_64__) && defined(__linux__)
+
+bool pin_to(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+// Smallest observed one-way delay from 'from' to 'to': counter of the
+// receiver minus the counter sent. It bounds from above how far the
+// receiver's counter can lag behind the sender's. False if either thread
+// could not be pinned (cpuset, cgroup): the measure would mean nothing.
+bool one_way(int from, int to, uint64_t& delay) {
+    std::atomic<uint64_t> stamp{0};
+    std::atomic<int> round{0};
+    std::atomic<int> ready{0};
+    std::atomic<bool> pinned{true};
+    int64_t best = INT64_MAX;
+
+    // Both threads learn whether both pins held before measuring
+    auto start = [&](int cpu) {
+        if (!pin_to(cpu)) {
+            pinned.store(false);
+        }
+        ready.fetch_add(1);
+        while (ready.load() != 2) {}
+        return pinned.load();
+    };
+    std::thread receiver([&]() {
+        if (!start(to)) return;
+        for (int i = 1; i <= calibration_rounds; i++) {
+            while (round.load(std::memory_order_acquire) != i) {}
+            int64_t delta = int64_t(Tsc::read() - stamp.load(std::memory_order_relaxed));
+            if (delta < best) best = delta;
+            round.store(-i, std::memory_order_release);
+        }
+    });
+    std::thread sender([&]() {
+        if (!start(from)) return;
+        for (int i = 1; i <= calibration_rounds; i++) {
+            stamp.store(Tsc::read(), std::memory_order_relaxed);
+            round.store(i, std::memory_order_release);
+            while (round.load(std::memory_order_acquire) != -i) {}
+        }
+    });
+    sender.join();
+    receiver.join();
+    if (!pinned.load()) {
+        return false;
+    }
+    delay = best < 0 ? uint64_t(-best) : uint64_t(best);
+    return true;
+}
+
+// Online CPUs of the machine, whatever the affinity of the calling thread:
+// the workers of the region may run on any of them
+std::vector<int> online_cpus() {
+    std::vector<int> cpus;
+    std::ifstream online("/sys/devices/system/cpu/online");
+    std::string range;
+    while (std::getline(online, range, ',')) {
+        size_t dash = range.find('-');
+        int low = std::atoi(range.c_str());
+        int high = dash == std::string::npos ? low : std::atoi(range.c_str() + dash + 1);
+        for (int cpu = low; cpu <= high; cpu++) {
+            cpus.push_back(cpu);
+        }
+    }
+    if (cpus.empty()) {
+        long count = sysconf(_SC_NPROCESSORS_ONLN);
+        for (long cpu = 0; cpu < count; cpu++) {
+            cpus.push_back(int(cpu));
+        }
+    }
+    return cpus;
+}
+
+// Largest one-way delay over every ordered pair of online CPUs, no_boundary
+// if a pair could not be measured
+uint64_t measure_boundary() {
+    std::vector<int> cpus = online_cpus();
+    uint64_t boundary = 0;
+    for (int from : cpus) {
+        for (int to : cpus) {
+            if (from == to) continue;
+            uint64_t delay;
+            if (!one_way(from, to, delay)) {
+                return Tsc::no_boundary;
+            }
+            if (delay > boundary) boundary = delay;
+        }
+    }
+    return boundary;
+}
+
+#else
+
+uint64_t measure_boundary() {
+    return 0;
+}
+
+#endif
+
+} // namespace
+
+bool Tsc::available() {
+#if defined(__x86_64__) && defined(__linux__)
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 5, "flags") == 0) {
+            return line.find(" constant_tsc") != std::string::npos && line.find(" nonstop_tsc") != std::string::npos;
+        }
+    }
+#endif
+    return false;
+}
+
+uint64_t Tsc::boundary() {
+    std::call_once(calibrated, []() {
+        const char* value = std::getenv("TM_TSC_BOUNDARY");
+        calibrated_boundary = value ? std::strtoull(value, nullptr, 0) : measure_boundary();
+    });
+    return calibrated_boundary;
+}
@@ -0,0 +1,36 @@
+#ifndef TSC_H
+#define TSC_H
+
+#include <cstdint>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+// Invariant time-stamp counter support for the ORDO clock scheme.
+namespace Tsc {
+
+// Whether the counter can serve as a global clock: x86-64 Linux reporting
+// constant_tsc and nonstop_tsc in /proc/cpuinfo
+bool available();
+
+// Calibration that could not run (a measuring thread could not be pinned)
+constexpr uint64_t no_boundary = UINT64_MAX;
+
+// Uncertainty window (in cycles) between the counters of any two online
+// cores, calibrated once per process, no_boundary on failure;
+// TM_TSC_BOUNDARY overrides the measure
+uint64_t boundary();
+
+inline uint64_t read() {
+#if defined(__x86_64__)
+    unsigned int aux;
+    return __rdtscp(&aux);
+#else
+    return 0;
+#endif
+}
+
+} // namespace Tsc
+
+#endif // TSC_H
@@ -0,0 +1,23 @@
+#include "UndoLog.hpp"
+#include <cstring>
+
+UndoLog::UndoLog(Arena* arena) : arena(arena) {
+}
+
+void UndoLog::save(void* address, size_t size) {
+    UndoEntry entry;
+    entry.address = address;
+    entry.size = size;
+    if (size > sizeof(entry.word)) {
+        entry.external = arena->allocate(size);
+    }
+    memcpy(entry.old_value(), address, size);
+    entries.push_back(entry);
+}
+
+void UndoLog::roll_back() {
+    for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+        memcpy(it->address, it->old_value(), it->size);
+    }
+    entries.clear();
+}
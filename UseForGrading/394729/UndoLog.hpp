@@ -0,0 +1,43 @@
+#ifndef UNDO_LOG_H
+#define UNDO_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Arena.hpp"
+
+struct UndoEntry {
+    void* address;
+    size_t size;
+    union {
+        uint64_t word;  // Value of words up to 8 bytes, stored inline
+        void* external; // Larger words live in the transaction arena
+    };
+
+    void* old_value() { return size <= sizeof(word) ? static_cast<void*>(&word) : external; }
+    const void* old_value() const { return size <= sizeof(word) ? static_cast<const void*>(&word) : external; }
+};
+
+// Values overwritten in place by an encounter-time locking transaction.
+// Entries are appended on every write, duplicates included: rolling back in
+// reverse order leaves each word with its oldest logged value.
+class UndoLog {
+private:
+    std::vector<UndoEntry> entries;
+    Arena* arena;
+
+public:
+    explicit UndoLog(Arena* arena);
+
+    bool empty() const { return entries.empty(); }
+    size_t size() const { return entries.size(); }
+
+    // Save the current value of the word before it is overwritten
+    void save(void* address, size_t size);
+    // Restore every saved word, newest first, and empty the log
+    void roll_back();
+    void clear() { entries.clear(); }
+};
+
+#endif // UNDO_LOG_H
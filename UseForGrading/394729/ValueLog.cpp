@@ -0,0 +1,25 @@
+#include "ValueLog.hpp"
+#include <cstring>
+
+ValueLog::ValueLog(Arena* arena) : arena(arena) {
+}
+
+void ValueLog::add(const void* address, const void* value, size_t size) {
+    ValueEntry entry;
+    entry.address = address;
+    entry.size = size;
+    if (size > sizeof(entry.word)) {
+        entry.external = arena->allocate(size);
+    }
+    memcpy(entry.value(), value, size);
+    entries.push_back(entry);
+}
+
+bool ValueLog::unchanged() const {
+    for (const ValueEntry& entry : entries) {
+        if (memcmp(entry.address, entry.value(), entry.size) != 0) {
+            return false;
+        }
+    }
+    return true;
+}
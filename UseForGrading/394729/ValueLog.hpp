@@ -0,0 +1,41 @@
+#ifndef VALUE_LOG_H
+#define VALUE_LOG_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Arena.hpp"
+
+struct ValueEntry {
+    const void* address;
+    size_t size;
+    union {
+        uint64_t word;  // Value of ranges up to 8 bytes, stored inline
+        void* external; // Larger ranges live in the transaction arena
+    };
+
+    void* value() { return size <= sizeof(word) ? static_cast<void*>(&word) : external; }
+    const void* value() const { return size <= sizeof(word) ? static_cast<const void*>(&word) : external; }
+};
+
+// Values returned by the reads of a NOrec transaction, one entry per
+// tm_read call. The read set is valid as long as memory still holds them.
+class ValueLog {
+private:
+    std::vector<ValueEntry> entries;
+    Arena* arena;
+
+public:
+    explicit ValueLog(Arena* arena);
+
+    size_t size() const { return entries.size(); }
+
+    // Log the value read from the range
+    void add(const void* address, const void* value, size_t size);
+    // Whether memory still holds every logged value
+    bool unchanged() const;
+    void clear() { entries.clear(); }
+};
+
+#endif // VALUE_LOG_H
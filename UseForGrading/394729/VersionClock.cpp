@@ -0,0 +1,123 @@
+#include "VersionClock.hpp"
+#include "Policy.hpp"
+#include "Tsc.hpp"
+#include "macros.h"
+
+// Scheme of this build: a policy variant fixes it (see Policy.hpp)
+static inline ClockScheme effective(ClockScheme configured) {
+    return Policy::fixed ? Policy::clock : configured;
+}
+
+VersionClock::VersionClock(ClockScheme scheme) : scheme(scheme), partitions(nullptr), boundary(0) {
+    if (scheme == ClockScheme::partitioned) {
+        partitions = new Counter[partition_count];
+    }
+    if (scheme == ClockScheme::tsc) {
+        boundary = Tsc::available() ? Tsc::boundary() : Tsc::no_boundary;
+        if (boundary == Tsc::no_boundary) {
+            boundary = 0;
+            this->scheme = ClockScheme::gv1;
+        }
+    }
+}
+
+VersionClock::~VersionClock() {
+    delete[] partitions;
+}
+
+uint64_t VersionClock::partitions_max() const {
+    uint64_t max = 0;
+    for (size_t i = 0; i < partition_count; i++) {
+        uint64_t value = partitions[i].value.load(std::memory_order_acquire);
+        if (value > max) max = value;
+    }
+    return max;
+}
+
+uint64_t VersionClock::read() const {
+    if (effective(scheme) == ClockScheme::partitioned) {
+        return partitions_max();
+    }
+    if (effective(scheme) == ClockScheme::tsc) {
+        return Tsc::read();
+    }
+    return global.value.load(std::memory_order_acquire);
+}
+
+uint64_t VersionClock::commit(size_t slot, uint64_t read_version, uint64_t floor, bool& must_validate) {
+    switch (effective(scheme)) {
+    case ClockScheme::tsc: {
+        // Any core's counter is at most 'boundary' ahead of ours: a reader
+        // sampling wv or more did so after our locks were taken
+        uint64_t wv = Tsc::read() + boundary + 1;
+        must_validate = true;
+        return wv > floor ? wv : floor + 1;
+    }
+    case ClockScheme::gv4: {
+        uint64_t current = global.value.load(std::memory_order_acquire);
+        if (global.value.compare_exchange_strong(current, current + 1)) {
+            must_validate = read_version + 1 != current + 1;
+            return current + 1;
+        }
+        // Another committer moved the clock after we locked: share its version
+        must_validate = true;
+        return current;
+    }
+    case ClockScheme::gv6: {
+        thread_local uint64_t commits = 0;
+        if (++commits % gv6_increment_period == 0) {
+            must_validate = true;
+            return global.value.fetch_add(1) + 1;
+        }
+    }
+    // fall through
+    case ClockScheme::gv5:
+        must_validate = true;
+        return global.value.load(std::memory_order_acquire) + 1;
+    case ClockScheme::partitioned: {
+        // Any partition holding a value >= wv was written after this read,
+        // hence after our locks were taken
+        uint64_t wv = partitions_max() + 1;
+        std::atomic<uint64_t>& own = partitions[slot % partition_count].value;
+        uint64_t current = own.load(std::memory_order_relaxed);
+        while (current < wv && !own.compare_exchange_weak(current, wv)) {}
+        must_validate = true;
+        return wv;
+    }
+    case ClockScheme::gv1:
+    default: {
+        uint64_t wv = global.value.fetch_add(1) + 1;
+        must_validate = read_version + 1 != wv;
+        return wv;
+    }
+    }
+}
+
+void VersionClock::settle(uint64_t wv) const {
+    // Only the tsc scheme hands out versions ahead of other threads' clocks
+    if (effective(scheme) == ClockScheme::tsc) {
+        while (Tsc::read() < wv + boundary) {
+            cpu_relax();
+        }
+    }
+}
+
+void VersionClock::observe(uint64_t version) {
+    if (effective(scheme) == ClockScheme::tsc) {
+        // The versions of other cores are within the window of our counter:
+        // wait it out so that an extension can pass the stripe
+        if (version <= Tsc::read() + 2 * boundary + 1) {
+            while (Tsc::read() < version) {
+                cpu_relax();
+            }
+        }
+        return;
+    }
+
+    // Lazy schemes let commits run ahead of the clock, bring it up to date
+    // so that the reader's next read version covers that commit
+    if (effective(scheme) == ClockScheme::gv5 || effective(scheme) == ClockScheme::gv6) {
+        uint64_t current = global.value.load(std::memory_order_relaxed);
+        while (current < version && !global.value.compare_exchange_weak(current, version)) {}
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef VERSION_CLOCK_H
+#define VERSION_CLOCK_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+enum class ClockScheme {
+    gv1,         // fetch_add on every writing commit
+    gv4,         // one CAS attempt, adopt the winner's value on failure
+    gv5,         // commit at clock + 1 without incrementing, readers advance the clock
+    gv6,         // gv5, with a real increment on a fraction of the commits
+    partitioned, // per-slot partitions, the clock is their maximum
+    tsc          // invariant TSC with a calibrated uncertainty window (ORDO), no shared counter
+};
+
+// Global version clock of a region, with selectable TL2 clock schemes.
+// Whatever the scheme, a read version >= some commit's write version is
+// only ever sampled after that committer acquired its locks, which is what
+// the stripe version checks rely on.
+class VersionClock {
+private:
+    struct alignas(64) Counter {
+        std::atomic<uint64_t> value{0};
+    };
+
+    static constexpr size_t partition_count = 16;
+    static constexpr uint64_t gv6_increment_period = 32;
+
+    ClockScheme scheme;
+    Counter global;
+    Counter* partitions; // Only for the partitioned scheme
+    uint64_t boundary;   // TSC uncertainty window, only for the tsc scheme
+
+    uint64_t partitions_max() const;
+
+public:
+    // The tsc scheme falls back to gv1 when the TSC is not invariant or
+    // its boundary could not be calibrated
+    explicit VersionClock(ClockScheme scheme);
+    ~VersionClock();
+    VersionClock(const VersionClock&) = delete;
+    VersionClock& operator=(const VersionClock&) = delete;
+
+    ClockScheme get_scheme() const { return scheme; }
+
+    // Sample the clock (read version, extension, reclamation horizon)
+    uint64_t read() const;
+    // Lowest value a read() on any thread may return from now on
+    uint64_t read_lower_bound() const { return scheme == ClockScheme::tsc ? read() - boundary : read(); }
+    // Write version of a committer holding its locks, above 'floor' (the
+    // versions of the stripes it locked). 'must_validate' is false only when
+    // no other commit can have happened since read_version.
+    uint64_t commit(size_t slot, uint64_t read_version, uint64_t floor, bool& must_validate);
+    // A reader met a stripe at 'version' above its read version
+    void observe(uint64_t version);
+    // Return once every later read() on any thread is >= wv
+    void settle(uint64_t wv) const;
+};
+
+#endif // VERSION_CLOCK_H
@@ -0,0 +1,173 @@
+#include "VersionHistory.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+
+#include "ThreadRegistry.hpp"
+
+VersionHistory::VersionHistory(size_t stripe_count, size_t word_size)
+    : chain_count(stripe_count), node_size((sizeof(VersionNode) + word_size + alignof(VersionNode) - 1) & ~(alignof(VersionNode) - 1)), horizon(0) {
+    chains = new std::atomic<VersionNode*>[chain_count];
+    dirty = new std::atomic<bool>[chain_count];
+    for (size_t i = 0; i < chain_count; i++) {
+        chains[i].store(nullptr, std::memory_order_relaxed);
+        dirty[i].store(false, std::memory_order_relaxed);
+    }
+    dirty_stripes.reserve(chain_count);
+    sweeping.reserve(chain_count);
+    snapshots = new Snapshot[ThreadRegistry::max_threads];
+    for (size_t i = 0; i < ThreadRegistry::max_threads; i++) {
+        snapshots[i].read_version.store(no_snapshot, std::memory_order_relaxed);
+    }
+    pools = new Pool[ThreadRegistry::max_threads];
+}
+
+VersionHistory::~VersionHistory() {
+    // Every node lives in a block of some pool
+    for (size_t i = 0; i < ThreadRegistry::max_threads; i++) {
+        for (void* block : pools[i].blocks) {
+            free(block);
+        }
+    }
+    delete[] pools;
+    delete[] chains;
+    delete[] dirty;
+    delete[] snapshots;
+}
+
+VersionNode* VersionHistory::allocate(size_t slot) {
+    Pool& pool = pools[slot];
+    if (!pool.free) {
+        char* block = static_cast<char*>(malloc(nodes_per_block * node_size));
+        if (!block) {
+            return nullptr;
+        }
+        pool.blocks.push_back(block);
+        for (size_t i = 0; i < nodes_per_block; i++) {
+            VersionNode* node = new (block + i * node_size) VersionNode();
+            node->next.store(pool.free, std::memory_order_relaxed);
+            pool.free = node;
+        }
+    }
+    VersionNode* node = pool.free;
+    pool.free = node->next.load(std::memory_order_relaxed);
+    return node;
+}
+
+void VersionHistory::free_chain(size_t slot, VersionNode* node) {
+    Pool& pool = pools[slot];
+    while (node) {
+        VersionNode* next = node->next.load(std::memory_order_relaxed);
+        node->next.store(pool.free, std::memory_order_relaxed);
+        pool.free = node;
+        node = next;
+    }
+}
+
+void VersionHistory::announce(size_t slot) {
+    // 0 keeps every version alive until the real read version is published
+    snapshots[slot].read_version.store(0, std::memory_order_seq_cst);
+}
+
+void VersionHistory::publish(size_t slot, uint64_t read_version) {
+    snapshots[slot].read_version.store(read_version, std::memory_order_release);
+}
+
+void VersionHistory::retire(size_t slot) {
+    snapshots[slot].read_version.store(no_snapshot, std::memory_order_release);
+}
+
+const VersionNode* VersionHistory::find(uint32_t stripe, const void* address, uint64_t read_version) const {
+    // The value seen at read_version is the one overwritten by the oldest
+    // commit newer than read_version
+    const VersionNode* found = nullptr;
+    for (const VersionNode* node = chains[stripe].load(std::memory_order_acquire); node && node->until > read_version;
+         node = node->next.load(std::memory_order_acquire)) {
+        if (node->address == address) {
+            found = node;
+        }
+    }
+    return found;
+}
+
+bool VersionHistory::push(size_t slot, uint32_t stripe, const void* address, size_t size, uint64_t until) {
+    VersionNode* node = allocate(slot);
+    if (!node) {
+        return false;
+    }
+    node->address = address;
+    node->until = until;
+    node->size = size;
+    memcpy(node->value(), address, size);
+    node->next.store(chains[stripe].load(std::memory_order_relaxed), std::memory_order_relaxed);
+    chains[stripe].store(node, std::memory_order_release);
+    if (node->next.load(std::memory_order_relaxed) && !dirty[stripe].exchange(true, std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> guard(dirty_lock);
+        dirty_stripes.push_back(stripe);
+    }
+    return true;
+}
+
+bool VersionHistory::cut(size_t slot, uint32_t stripe) {
+    uint64_t oldest = horizon.load(std::memory_order_acquire);
+    VersionNode* head = chains[stripe].load(std::memory_order_relaxed);
+    for (VersionNode* node = head; node; node = node->next.load(std::memory_order_relaxed)) {
+        if (node->until <= oldest) {
+            // Readers stop at this node at the latest, drop everything behind it
+            VersionNode* rest = node->next.exchange(nullptr, std::memory_order_relaxed);
+            free_chain(slot, rest);
+            break;
+        }
+    }
+    return head && head->next.load(std::memory_order_relaxed);
+}
+
+void VersionHistory::truncate(size_t slot, uint32_t stripe) {
+    cut(slot, stripe);
+}
+
+void VersionHistory::sweep(size_t slot, LockTable& locks) {
+    // One sweeper at a time, the others carry on with their commit
+    std::unique_lock<std::mutex> guard(dirty_lock, std::try_to_lock);
+    if (!guard.owns_lock()) {
+        return;
+    }
+    sweeping.swap(dirty_stripes);
+    for (uint32_t stripe : sweeping) {
+        VersionedLock* lock = locks.get(stripe);
+        uint64_t word = lock->load();
+        // A locked stripe belongs to a committer, which truncates it itself
+        if (!lock->lock(word, slot)) {
+            dirty_stripes.push_back(stripe);
+            continue;
+        }
+        if (cut(slot, stripe)) {
+            dirty_stripes.push_back(stripe);
+        } else {
+            dirty[stripe].store(false, std::memory_order_relaxed);
+        }
+        lock->unlock(word);
+    }
+    sweeping.clear();
+}
+
+void VersionHistory::refresh_horizon(uint64_t clock, size_t slot_count) {
+    uint64_t oldest = clock;
+    for (size_t slot = 0; slot < slot_count; slot++) {
+        uint64_t read_version = snapshots[slot].read_version.load(std::memory_order_seq_cst);
+        if (read_version < oldest) {
+            oldest = read_version;
+        }
+    }
+    // The horizon never moves backwards, a stale value is merely conservative
+    uint64_t current = horizon.load(std::memory_order_relaxed);
+    while (current < oldest && !horizon.compare_exchange_weak(current, oldest)) {}
+}
+
+void VersionHistory::push_waiting(size_t slot, uint32_t stripe, const void* address, size_t size, uint64_t until) {
+    while (!push(slot, stripe, address, size, until)) {
+        std::this_thread::yield();
+    }
+}
@@ -0,0 +1,101 @@
+#ifndef VERSION_HISTORY_H
+#define VERSION_HISTORY_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+#include "LockTable.hpp"
+
+// Previous committed value of a word, valid until (excluded) the commit
+// version of the transaction that overwrote it.
+struct VersionNode {
+    const void* address;
+    uint64_t until;
+    std::atomic<VersionNode*> next;
+    size_t size;
+
+    void* value() { return this + 1; }
+    const void* value() const { return this + 1; }
+};
+
+// Old versions of the words of each stripe, used by the multiversion mode so
+// read-only transactions can read the snapshot of their read version.
+//
+// Each stripe has a chain of nodes ordered by decreasing 'until'. Chains are
+// only modified by the committer holding the stripe lock: it prepends the
+// overwritten values, and cuts the chain after the first node that no active
+// reader can need (until <= reclaim horizon). Readers stop walking a chain at
+// the first node with until <= their read version, which is never past that
+// node, so the nodes behind it can be recycled right away.
+//
+// Nodes (all of one word size) come from per-slot pools refilled a block at
+// a time, and cut nodes go back to the pool of the slot cutting them, so
+// commits do not allocate in the steady state. A stripe with more than one
+// node is listed as dirty: a committer refreshing the horizon also cuts the
+// chains of the dirty stripes it can lock, so that old versions are
+// reclaimed even if their stripe is never written again.
+class VersionHistory {
+private:
+    struct alignas(64) Snapshot {
+        std::atomic<uint64_t> read_version;
+    };
+
+    struct alignas(64) Pool {
+        VersionNode* free = nullptr;
+        std::vector<void*> blocks; // Released with the history
+    };
+
+    static constexpr uint64_t no_snapshot = UINT64_MAX;
+    static constexpr size_t nodes_per_block = 256;
+
+    std::atomic<VersionNode*>* chains;
+    size_t chain_count;
+    size_t node_size;
+    Snapshot* snapshots; // One per thread slot
+    Pool* pools;         // One per thread slot
+    std::atomic<uint64_t> horizon;
+
+    std::atomic<bool>* dirty; // Per stripe: listed in 'dirty_stripes'
+    std::mutex dirty_lock;
+    std::vector<uint32_t> dirty_stripes; // Reserved for every stripe, never reallocates
+    std::vector<uint32_t> sweeping;
+
+    VersionNode* allocate(size_t slot);
+    void free_chain(size_t slot, VersionNode* node);
+    // Cut the chain of a locked stripe, true if more than one node is left
+    bool cut(size_t slot, uint32_t stripe);
+
+public:
+    VersionHistory(size_t stripe_count, size_t word_size);
+    ~VersionHistory();
+    VersionHistory(const VersionHistory&) = delete;
+    VersionHistory& operator=(const VersionHistory&) = delete;
+
+    // Reader side: announce the slot as active (pending) before sampling the
+    // clock, then publish the sampled read version; retire at the end
+    void announce(size_t slot);
+    void publish(size_t slot, uint64_t read_version);
+    void retire(size_t slot);
+
+    // Value of the word as of the given read version, nullptr if the word has
+    // not been overwritten since then
+    const VersionNode* find(uint32_t stripe, const void* address, uint64_t read_version) const;
+
+    // Committer side (of the given slot), stripe lock held
+    bool push(size_t slot, uint32_t stripe, const void* address, size_t size, uint64_t until);
+    // Same, waiting for memory instead of failing, for a commit that cannot abort
+    void push_waiting(size_t slot, uint32_t stripe, const void* address, size_t size, uint64_t until);
+    void truncate(size_t slot, uint32_t stripe);
+    // Cut the chains of the dirty stripes whose lock can be taken on behalf
+    // of the slot; the others stay dirty
+    void sweep(size_t slot, LockTable& locks);
+
+    // Recompute the reclaim horizon: the oldest read version an active or
+    // future reader may use. 'clock' must be sampled before the call.
+    void refresh_horizon(uint64_t clock, size_t slot_count);
+};
+
+#endif // VERSION_HISTORY_H
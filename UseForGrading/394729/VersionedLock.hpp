@@ -2,17 +2,46 @@
 #define VERSIONED_LOCK_H
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 
+// Versioned write-lock word.
+// Unlocked: version << 1. Locked: owner slot << 1 | 1, the owner keeps the
+// word it replaced to validate against it and to restore it on rollback.
 class VersionedLock {
 private:
     std::atomic<uint64_t> lock_and_version{0}; // Initialize to 0
 
 public:
     VersionedLock() = default;
-    bool lock();
-    void unlock();
-    void update_version(uint64_t new_version);
-    uint64_t load() const;
+
+    static bool is_locked(uint64_t word) { return word & 0x1; }
+    static uint64_t version_of(uint64_t word) { return word >> 1; }
+    static size_t owner_of(uint64_t word) { return size_t(word >> 1); }
+
+    // Lock for the given owner slot if the word is still the unlocked 'word'
+    bool lock(uint64_t word, size_t owner) {
+        return !is_locked(word) && lock_and_version.compare_exchange_strong(word, (uint64_t(owner) << 1) | 0x1);
+    }
+
+    // Release without committing: restore the word seen before locking
+    void unlock(uint64_t word) {
+        lock_and_version.store(word, std::memory_order_release);
+    }
+
+    void update_version(uint64_t new_version) {
+        lock_and_version.store(new_version << 1, std::memory_order_release); // Shift the version back into place and clear the lock bit
+    }
+
+    uint64_t load() const {
+        return lock_and_version.load(std::memory_order_acquire);
+    }
+
+    // Load for post-validation: the data reads before it cannot be reordered after it
+    uint64_t reload() const {
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return lock_and_version.load(std::memory_order_relaxed);
+    }
 };
 
 #endif // VERSIONED_LOCK_H
@@ -0,0 +1,104 @@
+#include "WriteSet.hpp"
+#include <cstring>
+
+static constexpr unsigned int initial_slot_bits = 6;
+
+WriteSet::WriteSet(Arena* arena)
+    : slots(size_t(1) << initial_slot_bits, 0), indexed(0), slot_bits(initial_slot_bits), generation(1), filter(0), arena(arena) {
+}
+
+void WriteSet::insert_slot(uint64_t h, size_t index) {
+    size_t mask = slots.size() - 1;
+    size_t i = h >> (64 - slot_bits);
+    while ((slots[i] >> 32) == generation) {
+        i = (i + 1) & mask;
+    }
+    slots[i] = (generation << 32) | (index + 1);
+}
+
+void WriteSet::index_entry(size_t index) {
+    const WriteSetEntry& entry = entries[index];
+    char* word = static_cast<char*>(entry.address);
+    for (size_t offset = 0; offset < entry.size_to_write; offset += entry.word_size) {
+        uint64_t h = hash(word + offset);
+        insert_slot(h, index);
+        filter |= signature(h);
+    }
+}
+
+void WriteSet::grow() {
+    // Keep the load factor at most 1/2, re-index every entry
+    while (indexed * 2 > slots.size()) {
+        slot_bits++;
+        slots.assign(size_t(1) << slot_bits, 0);
+    }
+    generation = 1;
+    for (size_t index = 0; index < entries.size(); index++) {
+        index_entry(index);
+    }
+}
+
+void WriteSet::put(void* address, uint32_t stripe, const void* value, size_t size) {
+    WriteSetEntry* existing = const_cast<WriteSetEntry*>(find(address));
+    if (existing) {
+        memcpy(existing->value_at(address), value, size);
+        return;
+    }
+
+    WriteSetEntry entry;
+    entry.address = address;
+    entry.stripe = stripe;
+    entry.stripe_shift = 0;
+    entry.size_to_write = size;
+    entry.word_size = size;
+    if (size > sizeof(entry.word)) {
+        entry.external = arena->allocate(size);
+    }
+    memcpy(entry.new_value(), value, size);
+    entries.push_back(entry);
+
+    indexed++;
+    if (indexed * 2 > slots.size()) {
+        grow();
+    } else {
+        index_entry(entries.size() - 1);
+    }
+}
+
+bool WriteSet::put_range(void* address, const void* value, size_t size, size_t word_size, uint32_t stripe, unsigned int stripe_shift) {
+    for (size_t offset = 0; offset < size; offset += word_size) {
+        if (find(static_cast<char*>(address) + offset)) return false;
+    }
+
+    WriteSetEntry entry;
+    entry.address = address;
+    entry.stripe = stripe;
+    entry.stripe_shift = stripe_shift;
+    entry.size_to_write = size;
+    entry.word_size = word_size;
+    if (size > sizeof(entry.word)) {
+        entry.external = arena->allocate(size);
+    }
+    memcpy(entry.new_value(), value, size);
+    entries.push_back(entry);
+
+    indexed += size / word_size;
+    if (indexed * 2 > slots.size()) {
+        grow();
+    } else {
+        index_entry(entries.size() - 1);
+    }
+    return true;
+}
+
+void WriteSet::clear() {
+    entries.clear();
+    indexed = 0;
+    filter = 0;
+    // Bumping the generation empties every slot without touching the table
+    generation++;
+    if (generation == (uint64_t(1) << 32)) {
+        slots.assign(slots.size(), 0);
+        generation = 1;
+    }
+}
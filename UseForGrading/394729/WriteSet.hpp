@@ -0,0 +1,92 @@
+#ifndef WRITE_SET_H
+#define WRITE_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Arena.hpp"
+
+// One written word, or a range of contiguous words written by a single call
+struct WriteSetEntry {
+    void* address;
+    uint32_t stripe;       // Stripe of the first word
+    uint32_t stripe_shift; // Ranges: 2^stripe_shift bytes share a stripe
+    size_t size_to_write;
+    size_t word_size;
+    union {
+        uint64_t word;  // Value of words up to 8 bytes, stored inline
+        void* external; // Larger words and ranges live in the transaction arena
+    };
+
+    void* new_value() { return size_to_write <= sizeof(word) ? static_cast<void*>(&word) : external; }
+    const void* new_value() const { return size_to_write <= sizeof(word) ? static_cast<const void*>(&word) : external; }
+    bool is_range() const { return size_to_write > word_size; }
+    bool covers(const void* addr) const {
+        return addr >= address && static_cast<const char*>(addr) < static_cast<const char*>(address) + size_to_write;
+    }
+    // New value of the word at addr, within this entry
+    void* value_at(const void* addr) { return static_cast<char*>(new_value()) + (static_cast<const char*>(addr) - static_cast<char*>(address)); }
+    const void* value_at(const void* addr) const { return static_cast<const char*>(new_value()) + (static_cast<const char*>(addr) - static_cast<const char*>(address)); }
+};
+
+// Write set keyed by word address.
+// Entries are kept in insertion order in a flat array and indexed by an
+// open-addressing (linear probing) table, a range entry once per word; a
+// 64-bit Bloom signature in front lets most read-after-write checks skip the
+// table entirely.
+class WriteSet {
+private:
+    std::vector<WriteSetEntry> entries;
+    // Slot = generation << 32 | (entry index + 1), slots of older generations are empty
+    std::vector<uint64_t> slots;
+    size_t indexed; // Words indexed in the table
+    unsigned int slot_bits;
+    uint64_t generation;
+    uint64_t filter;
+    Arena* arena;
+
+    static uint64_t hash(const void* address) {
+        return (uint64_t(address) >> 3) * UINT64_C(0x9E3779B97F4A7C15);
+    }
+    static uint64_t signature(uint64_t h) {
+        return (uint64_t(1) << (h >> 58)) | (uint64_t(1) << ((h >> 52) & 63));
+    }
+
+    void grow();
+    void insert_slot(uint64_t h, size_t index);
+    void index_entry(size_t index);
+
+public:
+    explicit WriteSet(Arena* arena);
+
+    using const_iterator = std::vector<WriteSetEntry>::const_iterator;
+    const_iterator begin() const { return entries.begin(); }
+    const_iterator end() const { return entries.end(); }
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Entry for the given word, nullptr if it was not written
+    const WriteSetEntry* find(const void* address) const {
+        uint64_t h = hash(address);
+        uint64_t sig = signature(h);
+        if ((filter & sig) != sig) return nullptr;
+
+        size_t mask = slots.size() - 1;
+        for (size_t i = h >> (64 - slot_bits);; i = (i + 1) & mask) {
+            uint64_t slot = slots[i];
+            if ((slot >> 32) != generation) return nullptr;
+            const WriteSetEntry& entry = entries[uint32_t(slot) - 1];
+            if (entry.covers(address)) return &entry;
+        }
+    }
+
+    // Record a write, overwriting the previous value of the word in place
+    void put(void* address, uint32_t stripe, const void* value, size_t size);
+    // Record contiguous words as one entry, false (nothing recorded) if any
+    // of them was written before
+    bool put_range(void* address, const void* value, size_t size, size_t word_size, uint32_t stripe, unsigned int stripe_shift);
+    void clear();
+};
+
+#endif // WRITE_SET_H
@@ -34,3 +34,14 @@
     #define unused(variable)
     #warning This compiler has no support for GCC attributes
 #endif
+
+/** Hint the processor that the caller is spin-waiting.
+**/
+#undef cpu_relax
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define cpu_relax() \
+        __builtin_ia32_pause()
+#else
+    #define cpu_relax() \
+        do {} while (0)
+#endif
@@ -0,0 +1,126 @@
+// Frees of a segment that is no longer live must be rejected.
+// Usage: double_free <library path>
+// A segment freed twice in one transaction, freed again after its free
+// committed, or freed by two concurrent transactions is given back once:
+// the next allocations all get distinct addresses. An irrevocable
+// transaction cannot abort: it ignores and counts its invalid frees.
+
+#include <atomic>
+#include <cstdio>
+#include <dlfcn.h>
+#include <set>
+#include <thread>
+#include <tm.hpp>
+#include "../tm_irrevocable.hpp"
+
+namespace {
+
+struct Library {
+    decltype(&::tm_create) create;
+    decltype(&::tm_destroy) destroy;
+    decltype(&::tm_begin) begin;
+    decltype(&::tm_end) end;
+    decltype(&::tm_alloc) alloc;
+    decltype(&::tm_free) free;
+    decltype(&::tm_begin_irrevocable) begin_irrevocable;
+    decltype(&::tm_invalid_frees) invalid_frees;
+};
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+void* allocate(const Library& tm, shared_t shared) {
+    void* segment = nullptr;
+    tx_t tx = tm.begin(shared, false);
+    if (tm.alloc(shared, tx, 64, &segment) != Alloc::success || !tm.end(shared, tx)) {
+        return nullptr;
+    }
+    return segment;
+}
+
+bool free_once(const Library& tm, shared_t shared, void* segment) {
+    tx_t tx = tm.begin(shared, false);
+    return tm.free(shared, tx, segment) && tm.end(shared, tx);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <library path>\n", argv[0]);
+        return 2;
+    }
+    void* module = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!module) {
+        std::fprintf(stderr, "%s\n", dlerror());
+        return 2;
+    }
+    Library tm{
+        reinterpret_cast<decltype(&::tm_create)>(dlsym(module, "tm_create")),
+        reinterpret_cast<decltype(&::tm_destroy)>(dlsym(module, "tm_destroy")),
+        reinterpret_cast<decltype(&::tm_begin)>(dlsym(module, "tm_begin")),
+        reinterpret_cast<decltype(&::tm_end)>(dlsym(module, "tm_end")),
+        reinterpret_cast<decltype(&::tm_alloc)>(dlsym(module, "tm_alloc")),
+        reinterpret_cast<decltype(&::tm_free)>(dlsym(module, "tm_free")),
+        reinterpret_cast<decltype(&::tm_begin_irrevocable)>(dlsym(module, "tm_begin_irrevocable")),
+        reinterpret_cast<decltype(&::tm_invalid_frees)>(dlsym(module, "tm_invalid_frees")),
+    };
+    shared_t shared = tm.create(64, 8);
+
+    // Twice in one transaction: the second free aborts it, the segment stays live
+    void* twice = allocate(tm, shared);
+    tx_t tx = tm.begin(shared, false);
+    check(tm.free(shared, tx, twice), "first free in a transaction");
+    check(!tm.free(shared, tx, twice), "second free of the same segment in a transaction");
+    check(free_once(tm, shared, twice), "free after the aborted double free");
+
+    // Again after the free committed
+    check(!free_once(tm, shared, twice), "free of a segment already freed");
+
+    // Two concurrent transactions: only the first to commit frees it
+    void* raced = allocate(tm, shared);
+    std::atomic<int> step{0};
+    bool other_committed = false;
+    std::thread other([&]() {
+        tx_t other_tx = tm.begin(shared, false);
+        bool freed = tm.free(shared, other_tx, raced);
+        step = 1;
+        while (step != 2) {
+            std::this_thread::yield();
+        }
+        other_committed = freed && tm.end(shared, other_tx);
+    });
+    while (step != 1) {
+        std::this_thread::yield();
+    }
+    bool committed = free_once(tm, shared, raced);
+    step = 2;
+    other.join();
+    check(committed != other_committed, "exactly one of two concurrent frees commits");
+
+    // Irrevocable: the second free and the free of a freed segment are ignored
+    void* kept = allocate(tm, shared);
+    tx = tm.begin_irrevocable(shared);
+    check(tm.free(shared, tx, kept) && tm.free(shared, tx, kept) && tm.free(shared, tx, twice), "irrevocable frees continue");
+    check(tm.end(shared, tx), "irrevocable transaction commits");
+    check(tm.invalid_frees(shared) == 2, "irrevocable invalid frees are counted");
+
+    // Every id and block was recycled once: the next segments are distinct
+    std::set<void*> segments;
+    for (int i = 0; i < 16; i++) {
+        void* segment = allocate(tm, shared);
+        check(segment && segments.insert(segment).second, "allocations after the frees are distinct");
+    }
+
+    tm.destroy(shared);
+    if (failures == 0) {
+        std::printf("double_free: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+// Encounter-time locking must undo an aborted transaction.
+// Usage: etl_rollback <library path>
+// With TM_LOCKING=etl, a transaction writes words in place (single words,
+// a range, the same word twice) then aborts on an invalid free: another
+// thread reads the old values back and can lock and commit every word the
+// aborted transaction had locked.
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <thread>
+#include <tm.hpp>
+
+namespace {
+
+struct Library {
+    decltype(&::tm_create) create;
+    decltype(&::tm_destroy) destroy;
+    decltype(&::tm_start) start;
+    decltype(&::tm_begin) begin;
+    decltype(&::tm_end) end;
+    decltype(&::tm_read) read;
+    decltype(&::tm_write) write;
+    decltype(&::tm_free) free;
+};
+
+constexpr size_t words = 16;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <library path>\n", argv[0]);
+        return 2;
+    }
+    // Encounter-time locking is a mode of the TL2 engine
+    setenv("TM_ENGINE", "tl2", 1);
+    setenv("TM_LOCKING", "etl", 1);
+    void* module = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!module) {
+        std::fprintf(stderr, "%s\n", dlerror());
+        return 2;
+    }
+    Library tm{
+        reinterpret_cast<decltype(&::tm_create)>(dlsym(module, "tm_create")),
+        reinterpret_cast<decltype(&::tm_destroy)>(dlsym(module, "tm_destroy")),
+        reinterpret_cast<decltype(&::tm_start)>(dlsym(module, "tm_start")),
+        reinterpret_cast<decltype(&::tm_begin)>(dlsym(module, "tm_begin")),
+        reinterpret_cast<decltype(&::tm_end)>(dlsym(module, "tm_end")),
+        reinterpret_cast<decltype(&::tm_read)>(dlsym(module, "tm_read")),
+        reinterpret_cast<decltype(&::tm_write)>(dlsym(module, "tm_write")),
+        reinterpret_cast<decltype(&::tm_free)>(dlsym(module, "tm_free")),
+    };
+    shared_t shared = tm.create(words * sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t* base = static_cast<uint64_t*>(tm.start(shared));
+
+    uint64_t initial[words];
+    for (size_t i = 0; i < words; i++) {
+        initial[i] = i + 1;
+    }
+    tx_t tx = tm.begin(shared, false);
+    check(tm.write(shared, tx, initial, sizeof(initial), base) && tm.end(shared, tx), "initial write");
+
+    // Written in place, then rolled back by the invalid free
+    uint64_t junk[4] = {100, 101, 102, 103};
+    tx = tm.begin(shared, false);
+    check(tm.write(shared, tx, &junk[0], sizeof(uint64_t), base), "single word write");
+    check(tm.write(shared, tx, junk, sizeof(junk), base + 4), "range write");
+    check(tm.write(shared, tx, &junk[1], sizeof(uint64_t), base), "second write of a word");
+    check(tm.write(shared, tx, &junk[2], sizeof(uint64_t), base + words - 1), "last word write");
+    check(!tm.free(shared, tx, base + 1), "invalid free aborts");
+
+    // Another slot, so that no lock word can pass for its own
+    std::thread other([&]() {
+        uint64_t seen[words];
+        tx_t ro = tm.begin(shared, true);
+        check(tm.read(shared, ro, base, sizeof(seen), seen) && tm.end(shared, ro), "lock words are released for readers");
+        for (size_t i = 0; i < words; i++) {
+            check(seen[i] == initial[i], "aborted writes are undone in memory");
+        }
+        uint64_t update[words];
+        for (size_t i = 0; i < words; i++) {
+            update[i] = 2 * initial[i];
+        }
+        tx_t rw = tm.begin(shared, false);
+        check(tm.write(shared, rw, update, sizeof(update), base) && tm.end(shared, rw), "lock words are released for writers");
+    });
+    other.join();
+    uint64_t seen[words];
+    tx = tm.begin(shared, true);
+    check(tm.read(shared, tx, base, sizeof(seen), seen) && tm.end(shared, tx), "read after the other writer");
+    for (size_t i = 0; i < words; i++) {
+        check(seen[i] == 2 * initial[i], "writes after the rollback commit");
+    }
+
+    tm.destroy(shared);
+    if (failures == 0) {
+        std::printf("etl_rollback: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
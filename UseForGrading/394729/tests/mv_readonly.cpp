@@ -0,0 +1,130 @@
+// Multiversion read-only transactions must never abort.
+// Usage: mv_readonly <library path>
+// With TM_MULTIVERSION, writers keep moving a sum between the words of the
+// first segment while readers run read-only transactions over all of them:
+// every read and every commit of a reader succeeds, and each snapshot sees
+// the sum unchanged.
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <thread>
+#include <vector>
+#include <tm.hpp>
+
+namespace {
+
+struct Library {
+    decltype(&::tm_create) create;
+    decltype(&::tm_destroy) destroy;
+    decltype(&::tm_start) start;
+    decltype(&::tm_begin) begin;
+    decltype(&::tm_end) end;
+    decltype(&::tm_read) read;
+    decltype(&::tm_write) write;
+};
+
+constexpr size_t words = 16;
+constexpr uint64_t total = 1000;
+
+std::atomic<int> failures{0};
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+// Move one unit between two words; retried until it commits
+void transfer(const Library& tm, shared_t shared, uint64_t* base, size_t from, size_t to) {
+    while (true) {
+        tx_t tx = tm.begin(shared, false);
+        uint64_t a, b;
+        if (!tm.read(shared, tx, base + from, sizeof(a), &a) || !tm.read(shared, tx, base + to, sizeof(b), &b)) {
+            continue;
+        }
+        a--;
+        b++;
+        if (tm.write(shared, tx, &a, sizeof(a), base + from) && tm.write(shared, tx, &b, sizeof(b), base + to) && tm.end(shared, tx)) {
+            return;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <library path>\n", argv[0]);
+        return 2;
+    }
+    // Only the TL2 engine with commit-time locking keeps a history
+    setenv("TM_ENGINE", "tl2", 1);
+    setenv("TM_LOCKING", "ctl", 1);
+    setenv("TM_MULTIVERSION", "1", 1);
+    void* module = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!module) {
+        std::fprintf(stderr, "%s\n", dlerror());
+        return 2;
+    }
+    Library tm{
+        reinterpret_cast<decltype(&::tm_create)>(dlsym(module, "tm_create")),
+        reinterpret_cast<decltype(&::tm_destroy)>(dlsym(module, "tm_destroy")),
+        reinterpret_cast<decltype(&::tm_start)>(dlsym(module, "tm_start")),
+        reinterpret_cast<decltype(&::tm_begin)>(dlsym(module, "tm_begin")),
+        reinterpret_cast<decltype(&::tm_end)>(dlsym(module, "tm_end")),
+        reinterpret_cast<decltype(&::tm_read)>(dlsym(module, "tm_read")),
+        reinterpret_cast<decltype(&::tm_write)>(dlsym(module, "tm_write")),
+    };
+    shared_t shared = tm.create(words * sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t* base = static_cast<uint64_t*>(tm.start(shared));
+
+    // The whole sum starts in the first word
+    tx_t tx = tm.begin(shared, false);
+    check(tm.write(shared, tx, &total, sizeof(total), base) && tm.end(shared, tx), "initial write");
+
+    std::atomic<bool> stop{false};
+    std::vector<std::thread> writers;
+    for (size_t w = 0; w < 2; w++) {
+        writers.emplace_back([&, w]() {
+            for (size_t i = 0; !stop; i++) {
+                transfer(tm, shared, base, (i + w) % words, (i * 7 + w + 1) % words);
+            }
+        });
+    }
+
+    for (int i = 0; i < 200; i++) {
+        uint64_t snapshot[words];
+        tx = tm.begin(shared, true);
+        bool read = true;
+        // Word by word, so that writers commit between the reads
+        for (size_t j = 0; j < words && read; j++) {
+            read = tm.read(shared, tx, base + j, sizeof(uint64_t), &snapshot[j]);
+            std::this_thread::yield();
+        }
+        check(read, "read-only reads succeed");
+        bool committed = read && tm.end(shared, tx);
+        check(!read || committed, "read-only transactions commit");
+        if (!committed) {
+            break;
+        }
+        uint64_t sum = 0;
+        for (size_t j = 0; j < words; j++) {
+            sum += snapshot[j];
+        }
+        check(sum == total, "snapshots are consistent");
+    }
+    stop = true;
+    for (std::thread& writer : writers) {
+        writer.join();
+    }
+
+    tm.destroy(shared);
+    if (failures == 0) {
+        std::printf("mv_readonly: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// Reads must see the transaction's own range writes.
+// Usage: range_overlap <library path>
+// A multi-word write is logged as one range entry: single-word and range
+// reads overlapping it, fully or partly, return the buffered bytes, a later
+// single-word write inside the range wins over it, and nothing reaches
+// memory before the commit (TM_LOCKING=ctl).
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <dlfcn.h>
+#include <thread>
+#include <tm.hpp>
+
+namespace {
+
+struct Library {
+    decltype(&::tm_create) create;
+    decltype(&::tm_destroy) destroy;
+    decltype(&::tm_start) start;
+    decltype(&::tm_begin) begin;
+    decltype(&::tm_end) end;
+    decltype(&::tm_read) read;
+    decltype(&::tm_write) write;
+};
+
+constexpr size_t words = 16;
+
+int failures = 0;
+
+void check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        failures++;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <library path>\n", argv[0]);
+        return 2;
+    }
+    // Commit-time locking buffers every write
+    setenv("TM_LOCKING", "ctl", 1);
+    void* module = dlopen(argv[1], RTLD_NOW | RTLD_LOCAL);
+    if (!module) {
+        std::fprintf(stderr, "%s\n", dlerror());
+        return 2;
+    }
+    Library tm{
+        reinterpret_cast<decltype(&::tm_create)>(dlsym(module, "tm_create")),
+        reinterpret_cast<decltype(&::tm_destroy)>(dlsym(module, "tm_destroy")),
+        reinterpret_cast<decltype(&::tm_start)>(dlsym(module, "tm_start")),
+        reinterpret_cast<decltype(&::tm_begin)>(dlsym(module, "tm_begin")),
+        reinterpret_cast<decltype(&::tm_end)>(dlsym(module, "tm_end")),
+        reinterpret_cast<decltype(&::tm_read)>(dlsym(module, "tm_read")),
+        reinterpret_cast<decltype(&::tm_write)>(dlsym(module, "tm_write")),
+    };
+    shared_t shared = tm.create(words * sizeof(uint64_t), sizeof(uint64_t));
+    uint64_t* base = static_cast<uint64_t*>(tm.start(shared));
+
+    // The region starts zeroed; words 4 to 11 are written as one range
+    uint64_t range[8];
+    for (size_t i = 0; i < 8; i++) {
+        range[i] = 100 + i;
+    }
+    tx_t tx = tm.begin(shared, false);
+    check(tm.write(shared, tx, range, sizeof(range), base + 4), "range write");
+
+    uint64_t word = 0;
+    check(tm.read(shared, tx, base + 6, sizeof(word), &word) && word == 102, "word read inside the range");
+    check(tm.read(shared, tx, base + 11, sizeof(word), &word) && word == 107, "word read at the end of the range");
+    check(tm.read(shared, tx, base + 3, sizeof(word), &word) && word == 0, "word read next to the range");
+
+    // Straddling the start of the range
+    uint64_t seen[4];
+    check(tm.read(shared, tx, base + 2, sizeof(seen), seen), "range read across the start");
+    check(seen[0] == 0 && seen[1] == 0 && seen[2] == 100 && seen[3] == 101, "range read merges memory and buffered words");
+
+    // A later word write inside the range takes precedence
+    uint64_t later = 42;
+    check(tm.write(shared, tx, &later, sizeof(later), base + 9), "word write inside the range");
+    check(tm.read(shared, tx, base + 9, sizeof(word), &word) && word == 42, "word read after the word write");
+    check(tm.read(shared, tx, base + 8, sizeof(seen), seen), "range read across the word write");
+    check(seen[0] == 104 && seen[1] == 42 && seen[2] == 106 && seen[3] == 107, "range read sees the latest write of each word");
+
+    // Buffered until the commit: another thread still sees zeroes
+    std::thread other([&]() {
+        uint64_t before[words];
+        tx_t ro = tm.begin(shared, true);
+        check(tm.read(shared, ro, base, sizeof(before), before) && tm.end(shared, ro), "read by another thread");
+        for (size_t i = 0; i < words; i++) {
+            check(before[i] == 0, "writes stay buffered before the commit");
+        }
+    });
+    other.join();
+    check(tm.end(shared, tx), "commit");
+
+    uint64_t after[words];
+    tx = tm.begin(shared, true);
+    check(tm.read(shared, tx, base, sizeof(after), after) && tm.end(shared, tx), "read after the commit");
+    for (size_t i = 0; i < words; i++) {
+        uint64_t expected = i == 9 ? 42 : i >= 4 && i < 12 ? 100 + (i - 4) : 0;
+        check(after[i] == expected, "committed values");
+    }
+
+    tm.destroy(shared);
+    if (failures == 0) {
+        std::printf("range_overlap: ok\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -22,30 +22,378 @@
 
 // Added headers
 
+#include <cassert>
 #include <cstdlib>
 #include <cstring>
 #include <mutex>
+#include <thread>
 #include "tm.hpp"
 #include "SharedMemory.hpp"
 #include "Transaction.hpp"
-
-#include <iostream>
+#include "ThreadRegistry.hpp"
+#include "tm_irrevocable.hpp"
+#include "Trace.hpp"
 
 // ADDED UTILS
 
-// Stop at stop_addr, if stop_addr is NULL, unlock the entire write set
-void utils_unlock_set(SharedMemory* shared_mem, Transaction* transaction, void* stop_addr) {
-    // Unlock all locks in the write set up to addr
-    for (const auto& [addr, entry] : transaction->get_write_set()) {
-        if (!addr) {
-            std::cerr << "Unlocking NULL address" << std::endl;
-            exit(1);
+// Decode the opaque transaction handle (thread slot) into its context
+static inline Transaction* utils_get_transaction(tx_t tx) {
+    return ThreadRegistry::get(static_cast<size_t>(tx));
+}
+
+// Release the stripes locked by a failed commit, restoring their words
+static void utils_release_locks(SharedMemory* shared_mem, Transaction* transaction) {
+    for (const LockedStripe& locked : transaction->get_locked()) {
+        shared_mem->get_lock_at(locked.stripe)->unlock(locked.word);
+    }
+    transaction->clear_locked();
+}
+
+// Transactions ended between two reports to the stripe sizer and the mode switch
+static constexpr uint64_t stats_report_period = 64;
+
+// Feed the adaptive stripe sizer and the mode switch with the access statistics of a context
+static inline void utils_report_stats(SharedMemory* shared_mem, Transaction* transaction) {
+    StripeSizer& sizer = shared_mem->get_stripe_sizer();
+    ModeSwitch& mode = shared_mem->get_mode();
+    if ((sizer.is_adaptive() || mode.is_enabled()) && transaction->get_unreported() >= stats_report_period) {
+        AccessStats stats = transaction->take_stats();
+        if (sizer.is_adaptive()) {
+            sizer.report(stats);
+        }
+        if (mode.is_enabled()) {
+            mode.report(stats);
+        }
+    }
+}
+
+// Leave the serial gate: read-write transactions passed it at tm_begin, an
+// irrevocable one holds its token
+static inline void utils_leave_gate(SharedMemory* shared_mem, Transaction* transaction) {
+    if (transaction->is_irrevocable()) {
+        shared_mem->get_gate().release();
+    } else if (!transaction->is_read_only_tx()) {
+        shared_mem->get_gate().exit(transaction->get_slot());
+    }
+}
+
+// Abort: undo the in-place writes and drop the locks (if any), give back the
+// segments allocated, let the contention manager pace the retry, reset the context
+static void utils_abort(SharedMemory* shared_mem, Transaction* transaction) {
+    // Irrevocable transactions commit whatever happens
+    assert(!transaction->is_irrevocable());
+    transaction->roll_back();
+    if (transaction->is_pessimistic()) {
+        // Rolled back under the global lock, the only one taken
+        if (transaction->is_read_only_tx()) {
+            shared_mem->get_mode().get_lock().unlock_shared();
+        } else {
+            shared_mem->get_mode().get_lock().unlock();
+        }
+    } else {
+        utils_release_locks(shared_mem, transaction);
+    }
+    // Never published: no other transaction can hold their addresses
+    for (const CapturedSegment& segment : transaction->get_allocs()) {
+        shared_mem->release_segment(transaction->get_slot(), segment.start);
+    }
+    shared_mem->get_epochs().exit(transaction->get_slot());
+    if (shared_mem->get_engine() == Engine::tl2) {
+        // NOrec and RingSTM transactions enter neither the gate nor the mode switch
+        if (!transaction->is_pessimistic()) {
+            utils_leave_gate(shared_mem, transaction);
+        }
+        shared_mem->get_mode().exit(transaction->get_slot());
+    }
+    shared_mem->get_contention().on_abort(transaction);
+    transaction->abort();
+    utils_report_stats(shared_mem, transaction);
+}
+
+// Claim the segments freed by a committing transaction, all or none: a
+// concurrent transaction freeing one of them committed first
+static bool utils_claim_frees(SharedMemory* shared_mem, Transaction* transaction) {
+    const std::vector<void*>& frees = transaction->get_frees();
+    for (size_t i = 0; i < frees.size(); i++) {
+        if (!shared_mem->claim_segment(frees[i])) {
+            for (size_t k = 0; k < i; k++) {
+                shared_mem->unclaim_segment(frees[k]);
+            }
+            return false;
         }
-        if (addr == stop_addr) break;
-        shared_mem->get_lock(addr)->unlock();
+    }
+    return true;
+}
+
+// Give back the claims of a commit that failed after utils_claim_frees
+static void utils_unclaim_frees(SharedMemory* shared_mem, Transaction* transaction) {
+    for (void* segment : transaction->get_frees()) {
+        shared_mem->unclaim_segment(segment);
     }
 }
 
+// Writing commits between two refreshes of the history reclaim horizon
+static constexpr uint64_t history_refresh_period = 64;
+// Spins on a locked stripe before yielding the processor to its owner
+static constexpr unsigned int spin_yield_period = 64;
+
+// Multiversion read of one word for a read-only transaction: the current
+// value if it is not newer than the snapshot, otherwise the old version
+// kept in the history. Never fails.
+static void utils_read_snapshot(SharedMemory* shared_mem, Transaction* transaction, uint32_t stripe, const void* source_word, void* target_word, size_t align) {
+    VersionedLock* lock = shared_mem->get_lock_at(stripe);
+    for (unsigned int spins = 1;; spins++) {
+        uint64_t l = lock->load();
+        if (VersionedLock::is_locked(l)) {
+            // A committer is writing back, its values may belong to our snapshot
+            if (spins % spin_yield_period == 0) {
+                std::this_thread::yield();
+            } else {
+                cpu_relax();
+            }
+            continue;
+        }
+        if (VersionedLock::version_of(l) > transaction->get_read_version()) {
+            shared_mem->get_clock().observe(VersionedLock::version_of(l));
+            const VersionNode* node = shared_mem->get_history()->find(stripe, source_word, transaction->get_read_version());
+            if (node) {
+                memcpy(target_word, node->value(), align);
+                return;
+            }
+            // Another word of the stripe was overwritten, this one is still current
+        }
+        memcpy(target_word, source_word, align);
+        if (lock->reload() == l) {
+            return;
+        }
+    }
+}
+
+// Whether a stripe of the read set (lock word 'l') is unchanged since the
+// read version; stripes we locked are judged by the word they held before
+static inline bool utils_unchanged(Transaction* transaction, uint32_t stripe, uint64_t l) {
+    if (VersionedLock::is_locked(l)) {
+        const uint64_t* saved = transaction->find_locked(stripe);
+        if (!saved) {
+            return false;
+        }
+        l = *saved;
+    }
+    return VersionedLock::version_of(l) <= transaction->get_read_version();
+}
+
+// Timestamp extension: move the read version to the current clock if no
+// stripe of the read set changed since the current read version
+static bool utils_extend(SharedMemory* shared_mem, Transaction* transaction) {
+    uint64_t now = shared_mem->get_version_clock();
+    for (uint32_t stripe : transaction->get_read_set()) {
+        if (!utils_unchanged(transaction, stripe, shared_mem->get_lock_at(stripe)->load())) {
+            return false;
+        }
+    }
+    transaction->set_read_version(now);
+    return true;
+}
+
+// A stripe newer than the read version was met: let the clock catch up with
+// it, then try to extend the read version
+static bool utils_catch_up(SharedMemory* shared_mem, Transaction* transaction, uint64_t version) {
+    shared_mem->get_clock().observe(version);
+    return shared_mem->extension_enabled() && utils_extend(shared_mem, transaction);
+}
+
+// Lock word of a stripe about to be read: waits out its owner as the
+// contention manager allows and extends the read version past newer
+// versions when possible. The caller aborts unless the returned word is
+// unlocked and not newer than the read version.
+static uint64_t utils_sample_lock(SharedMemory* shared_mem, Transaction* transaction, const VersionedLock* lock) {
+    uint64_t l = lock->load();
+    for (;;) {
+        if (VersionedLock::is_locked(l)) {
+            if (!shared_mem->get_contention().wait_for(transaction, lock, l)) {
+                return l;
+            }
+            continue;
+        }
+        if (VersionedLock::version_of(l) <= transaction->get_read_version() || !utils_catch_up(shared_mem, transaction, VersionedLock::version_of(l))) {
+            return l;
+        }
+        l = lock->load();
+    }
+}
+
+// Whether the stripe is locked by the given transaction (encounter-time locking)
+static inline bool utils_owned(const VersionedLock* lock, tx_t tx) {
+    uint64_t l = lock->load();
+    return VersionedLock::is_locked(l) && VersionedLock::owner_of(l) == tx;
+}
+
+// Encounter-time locking write of a run of words sharing a stripe: lock the
+// stripe on first encounter, save the old values, write in place
+static bool utils_write_eager(SharedMemory* shared_mem, Transaction* transaction, tx_t tx, uint32_t stripe, const WordRange& words, size_t begin, size_t end, const void* source, size_t align) {
+    VersionedLock* lock = shared_mem->get_lock_at(stripe);
+    if (!utils_owned(lock, tx)) {
+        uint64_t l;
+        do {
+            // A stripe newer than the read version may hide a stale read, extend or fail
+            l = utils_sample_lock(shared_mem, transaction, lock);
+            if (VersionedLock::is_locked(l) || VersionedLock::version_of(l) > transaction->get_read_version()) {
+                return false;
+            }
+        } while (!lock->lock(l, tx));
+        transaction->add_locked(stripe, l);
+    }
+    if (words.stride == align) {
+        // Contiguous words: one undo entry and one copy for the run
+        void* target_run = words.first + begin * align;
+        transaction->save_undo(target_run, (end - begin) * align);
+        memcpy(target_run, (const char*)source + begin * align, (end - begin) * align);
+        return true;
+    }
+    for (size_t k = begin; k < end; k++) {
+        void* target_word = words.first + k * words.stride;
+        transaction->save_undo(target_word, align);
+        memcpy(target_word, (const char*)source + k * align, align);
+    }
+    return true;
+}
+
+// Words of a write set range entry, contiguous by construction
+static WordRange utils_entry_words(const WriteSetEntry& entry) {
+    return WordRange{static_cast<char*>(entry.address), entry.word_size, 0, entry.stripe_shift};
+}
+
+// Copy count words out of the shared region, in one go when they are contiguous
+static void utils_copy_words(const WordRange& words, void* target, size_t count, size_t align) {
+    if (words.stride == align) {
+        memcpy(target, words.first, count * align);
+        return;
+    }
+    for (size_t k = 0; k < count; k++) {
+        memcpy((char*)target + k * align, words.first + k * words.stride, align);
+    }
+}
+
+// Overwrite the words copied to target with the values this transaction wrote
+static void utils_overlay_writes(Transaction* transaction, const WordRange& words, void* target, size_t count, size_t align) {
+    if (transaction->get_write_set().empty()) {
+        return;
+    }
+    for (size_t k = 0; k < count; k++) {
+        void* source_word = words.first + k * words.stride;
+        const WriteSetEntry* entry = transaction->find_write(source_word);
+        if (entry) {
+            memcpy((char*)target + k * align, entry->value_at(source_word), align);
+        }
+    }
+}
+
+// Irrevocable write: lock the stripe if not ours yet, then write in place.
+// No other writer runs, the lock only keeps readers off the words.
+static void utils_write_irrevocable(SharedMemory* shared_mem, Transaction* transaction, tx_t tx, uint32_t stripe, const WordRange& words, size_t begin, size_t end, const void* source, size_t align) {
+    VersionedLock* lock = shared_mem->get_lock_at(stripe);
+    if (!utils_owned(lock, tx)) {
+        uint64_t l = lock->load();
+        while (VersionedLock::is_locked(l) || !lock->lock(l, tx)) {
+            cpu_relax();
+            l = lock->load();
+        }
+        transaction->add_locked(stripe, l);
+    }
+    for (size_t k = begin; k < end; k++) {
+        memcpy(words.first + k * words.stride, (const char*)source + k * align, align);
+    }
+}
+
+// Whether every lock sampled by the current read still holds the word seen,
+// adding the stripes to the read set if asked
+static bool utils_check_samples(SharedMemory* shared_mem, Transaction* transaction, bool record) {
+    for (const LockedStripe& sample : transaction->get_samples()) {
+        if (shared_mem->get_lock_at(sample.stripe)->reload() != sample.word) {
+            return false;
+        }
+    }
+    if (record) {
+        for (const LockedStripe& sample : transaction->get_samples()) {
+            transaction->add_read(sample.stripe);
+        }
+    }
+    return true;
+}
+
+// Flags of the trace event of a started transaction
+static inline uint16_t utils_begin_flags(Transaction* transaction) {
+    return (transaction->is_read_only_tx() ? Trace::begin_read_only : 0)
+        | (transaction->is_irrevocable() ? Trace::begin_irrevocable : 0)
+        | (transaction->is_pessimistic() ? Trace::begin_pessimistic : 0);
+}
+
+// Begin a transaction in the context of the given slot. In the pessimistic
+// mode it takes the global lock. Otherwise read-write transactions pass the
+// serial gate first, an irrevocable one takes its token and waits for the
+// other writers to drain.
+static tx_t utils_begin(SharedMemory* shared_mem, size_t slot, bool is_ro, bool irrevocable) {
+    Transaction* transaction = ThreadRegistry::get(slot);
+    if (shared_mem->get_engine() == Engine::norec) {
+        // The snapshot is the sequence lock, taken for good by an irrevocable transaction
+        shared_mem->get_epochs().enter(slot);
+        transaction->begin(irrevocable ? shared_mem->get_norec().begin_serial() : shared_mem->get_norec().begin(), is_ro);
+        if (irrevocable) {
+            transaction->set_irrevocable();
+        }
+        shared_mem->get_contention().on_begin(transaction);
+        return static_cast<tx_t>(slot);
+    }
+    if (shared_mem->get_engine() == Engine::ring) {
+        // The start is a ring timestamp, an irrevocable transaction takes the next one
+        shared_mem->get_epochs().enter(slot);
+        transaction->begin(irrevocable ? shared_mem->get_ring()->begin_serial() : shared_mem->get_ring()->begin(), is_ro);
+        if (irrevocable) {
+            transaction->set_irrevocable();
+        }
+        shared_mem->get_contention().on_begin(transaction);
+        return static_cast<tx_t>(slot);
+    }
+
+    if (shared_mem->get_mode().enter(slot)) {
+        if (is_ro) {
+            shared_mem->get_mode().get_lock().lock_shared();
+        } else {
+            shared_mem->get_mode().get_lock().lock();
+        }
+        shared_mem->get_epochs().enter(slot);
+        transaction->begin(shared_mem->get_version_clock(), is_ro);
+        transaction->set_pessimistic();
+        return static_cast<tx_t>(slot);
+    }
+
+    if (irrevocable) {
+        shared_mem->get_gate().acquire(slot);
+    } else if (!is_ro) {
+        shared_mem->get_gate().enter(slot);
+    }
+
+    // Segments we may reach stay allocated until we leave the epoch
+    shared_mem->get_epochs().enter(slot);
+
+    VersionHistory* history = shared_mem->get_history();
+    if (is_ro && history) {
+        // Snapshot readers pin the history from before they sample the clock
+        history->announce(slot);
+        transaction->begin(shared_mem->get_version_clock(), is_ro);
+        history->publish(slot, transaction->get_read_version());
+    } else {
+        transaction->begin(shared_mem->get_version_clock(), is_ro);
+    }
+    if (irrevocable) {
+        transaction->set_irrevocable();
+    }
+    shared_mem->get_contention().on_begin(transaction);
+
+    // Return the opaque handle (the thread slot)
+    return static_cast<tx_t>(slot);
+}
+
 //
 // End added headers
 /** Create (i.e. allocate + init) a new shared memory region, with one first non-free-able allocated segment of the requested size and alignment.
@@ -54,10 +402,10 @@ void utils_unlock_set(SharedMemory* shared_mem, Transaction* transaction, void*
  * @return Opaque shared memory region handle, 'invalid_shared' on failure
 **/
 shared_t tm_create(size_t size, size_t align) noexcept {
-    std::cout << "TM_CREATE USER CALL: " << size << ", " << align << std::endl;
+    TM_TRACE_EVENT(ThreadRegistry::current_slot(), create, 0, size, align);
     // Allocate and initialize the shared memory region
     try {
-        return static_cast<shared_t>(new SharedMemory(size, align));
+        return static_cast<shared_t>(new SharedMemory(size, align, Config::from_environment(size, align)));
     } catch (const std::exception& e) {
         return invalid_shared;
     }
@@ -69,6 +417,8 @@ shared_t tm_create(size_t size, size_t align) noexcept {
 void tm_destroy(shared_t shared) noexcept {
     SharedMemory* shared_mem = static_cast<SharedMemory*>(shared);
     delete shared_mem;
+    TM_TRACE_EVENT(ThreadRegistry::current_slot(), destroy, 0, 0, 0);
+    TM_TRACE_FLUSH();
 }
 
 /** [thread-safe] Return the start address of the first allocated segment in the shared memory region.
@@ -103,15 +453,34 @@ size_t   tm_align(shared_t shared) noexcept {
  * @param is_ro  Whether the transaction is read-only
  * @return Opaque transaction ID, 'invalid_tx' on failure
 **/
-int counter = 1;
 tx_t tm_begin(shared_t shared, bool is_ro) noexcept {
     SharedMemory* shared_mem = static_cast<SharedMemory*>(shared);
-    std::cout << "BEGIN TRANSACTION USER CALL: " << counter++ << ", " << is_ro << std::endl;
-    // Create a new Transaction object
-    Transaction* tx = new Transaction(shared_mem->get_version_clock(), is_ro);
+    // Reuse the calling thread's transaction context
+    size_t slot = ThreadRegistry::current_slot();
+    if (unlikely(slot == ThreadRegistry::no_slot)) {
+        return invalid_tx;
+    }
 
-    // Return the opaque handle (convert Transaction* to tx_t)
-    return reinterpret_cast<tx_t>(tx);
+    // A read-write transaction that keeps aborting retries irrevocably
+    size_t irrevocable_after = shared_mem->get_irrevocable_after();
+    bool irrevocable = !is_ro && irrevocable_after != 0 && ThreadRegistry::get(slot)->get_aborts() >= irrevocable_after;
+    tx_t tx = utils_begin(shared_mem, slot, is_ro, irrevocable);
+    TM_TRACE_EVENT(slot, begin, utils_begin_flags(ThreadRegistry::get(slot)), ThreadRegistry::get(slot)->get_read_version(), 0);
+    return tx;
+}
+
+/** [thread-safe] Begin a new irrevocable read-write transaction on the given shared memory region.
+ * @param shared Shared memory region to start a transaction on
+ * @return Opaque transaction ID, 'invalid_tx' on failure
+**/
+tx_t tm_begin_irrevocable(shared_t shared) noexcept {
+    size_t slot = ThreadRegistry::current_slot();
+    if (unlikely(slot == ThreadRegistry::no_slot)) {
+        return invalid_tx;
+    }
+    tx_t tx = utils_begin(static_cast<SharedMemory*>(shared), slot, false, true);
+    TM_TRACE_EVENT(slot, begin, utils_begin_flags(ThreadRegistry::get(slot)), ThreadRegistry::get(slot)->get_read_version(), 0);
+    return tx;
 }
 
 /** [thread-safe] End the given transaction.
@@ -120,57 +489,218 @@ tx_t tm_begin(shared_t shared, bool is_ro) noexcept {
  * @return Whether the whole transaction committed
 **/
 bool tm_end(shared_t shared, tx_t tx) noexcept {
-    std::cout << "\n\n\n\n\nEND TRANSACTION USER CALL: " << tx << std::endl;
     SharedMemory* shared_mem = static_cast<SharedMemory*>(shared);
-    Transaction* transaction = reinterpret_cast<Transaction*>(tx);
+    Transaction* transaction = utils_get_transaction(tx);
+
+    if (transaction->is_pessimistic()) {
+        // Everything was done in place under the global lock
+        if (!utils_claim_frees(shared_mem, transaction)) {
+            utils_abort(shared_mem, transaction);
+            return false;
+        }
+        if (transaction->is_read_only_tx()) {
+            shared_mem->get_mode().get_lock().unlock_shared();
+        } else {
+            shared_mem->get_mode().get_lock().unlock();
+        }
+        EpochManager& epochs = shared_mem->get_epochs();
+        epochs.exit(tx);
+        for (void* segment : transaction->get_frees()) {
+            epochs.retire(tx, segment);
+        }
+        epochs.collect(tx);
+        shared_mem->get_mode().exit(tx);
+        transaction->commit(0);
+        utils_report_stats(shared_mem, transaction);
+        return true;
+    }
+
+    if (shared_mem->get_engine() != Engine::tl2) {
+        // Reads were validated as they went, only writers have to commit
+        bool committed;
+        if (shared_mem->get_engine() == Engine::norec) {
+            NOrec& norec = shared_mem->get_norec();
+            if (transaction->is_irrevocable()) {
+                norec.end_serial(transaction);
+                committed = true;
+            } else {
+                committed = utils_claim_frees(shared_mem, transaction);
+                if (committed && !transaction->get_write_set().empty() && !norec.commit(transaction)) {
+                    utils_unclaim_frees(shared_mem, transaction);
+                    committed = false;
+                }
+            }
+        } else {
+            RingSTM* ring = shared_mem->get_ring();
+            if (transaction->is_irrevocable()) {
+                ring->end_serial(transaction);
+                committed = true;
+            } else {
+                committed = utils_claim_frees(shared_mem, transaction);
+                if (committed && !transaction->get_write_set().empty() && !ring->commit(transaction)) {
+                    utils_unclaim_frees(shared_mem, transaction);
+                    committed = false;
+                }
+            }
+        }
+        if (!committed) {
+            utils_abort(shared_mem, transaction);
+            return false;
+        }
+        EpochManager& epochs = shared_mem->get_epochs();
+        epochs.exit(tx);
+        for (void* segment : transaction->get_frees()) {
+            epochs.retire(tx, segment);
+        }
+        epochs.collect(tx);
+        transaction->commit(0);
+        utils_report_stats(shared_mem, transaction);
+        return true;
+    }
 
     // If it's a read-only transaction, we can commit immediately
+    VersionHistory* history = shared_mem->get_history();
     if (transaction->is_read_only_tx()) {
-        delete transaction;
+        if (history) {
+            history->retire(tx);
+        }
+        shared_mem->get_epochs().exit(tx);
+        shared_mem->get_mode().exit(tx);
+        transaction->commit(0);
+        utils_report_stats(shared_mem, transaction);
         return true;
     }
 
-    // Acquire locks for all locations in the write set
-    for (const auto& [addr, entry] : transaction->get_write_set()) {
-        VersionedLock* lock = shared_mem->get_lock(addr);
-        if (!lock->lock()) {
-            // If we fail to acquire any lock, release all acquired locks and abort
-            utils_unlock_set(shared_mem, transaction, addr);
-            
-            delete transaction;
-            return false;
+    // Acquire the stripes covering the write set, each once and in stripe
+    // order so that concurrent committers cannot convoy or deadlock
+    // (encounter-time locking holds them already)
+    for (const WriteSetEntry& entry : transaction->get_write_set()) {
+        if (!entry.is_range()) {
+            transaction->add_write_stripe(entry.stripe);
+            continue;
+        }
+        WordRange words = utils_entry_words(entry);
+        size_t count = entry.size_to_write / entry.word_size;
+        for (size_t i = 0; i < count; i = shared_mem->stripe_run_end(words, i, count)) {
+            transaction->add_write_stripe(shared_mem->get_stripe(words, i));
+        }
+    }
+    ContentionManager& contention = shared_mem->get_contention();
+    contention.on_lock(transaction);
+    uint64_t locked_version = 0; // Highest version among the locked stripes
+    for (const LockedStripe& locked : transaction->get_locked()) {
+        if (VersionedLock::version_of(locked.word) > locked_version) {
+            locked_version = VersionedLock::version_of(locked.word);
+        }
+    }
+    for (uint32_t stripe : transaction->sort_write_stripes()) {
+        VersionedLock* lock = shared_mem->get_lock_at(stripe);
+        uint64_t l = lock->load();
+        while (!lock->lock(l, tx)) {
+            if (!VersionedLock::is_locked(l)) {
+                l = lock->load(); // Lost the race, see who won it
+                continue;
+            }
+            if (transaction->is_irrevocable()) {
+                // Cannot give up: wait for the owner
+                cpu_relax();
+                l = lock->load();
+                continue;
+            }
+            if (!contention.wait_for(transaction, lock, l)) {
+                // If we fail to acquire any lock, release the acquired ones and abort
+                utils_abort(shared_mem, transaction);
+                return false;
+            }
+        }
+        transaction->add_locked(stripe, l);
+        if (VersionedLock::version_of(l) > locked_version) {
+            locked_version = VersionedLock::version_of(l);
         }
     }
 
-    // Increment the global version clock
-    transaction->set_wv(shared_mem->increment_version_clock());
+    // Get the write version from the global version clock
+    bool must_validate;
+    transaction->set_wv(shared_mem->get_clock().commit(tx, transaction->get_read_version(), locked_version, must_validate));
 
-    if (transaction->get_read_version() + 1 != transaction->get_wv()) { // Checking special case where read set validation not needed
+    // An irrevocable transaction ran alone among writers, its reads hold
+    if (must_validate && !transaction->is_irrevocable()) { // Checking special case where read set validation not needed
         // Validate the read set
-        for (const auto& read_set_entry : transaction->get_read_set()) {
-            VersionedLock* lock = shared_mem->get_lock(read_set_entry->address);
-            uint64_t l = lock->load();
-            if (l & 0x1 || (l >> 1) > transaction->get_read_version()) {
+        for (uint32_t stripe : transaction->get_read_set()) {
+            if (!utils_unchanged(transaction, stripe, shared_mem->get_lock_at(stripe)->load())) {
                 // If validation fails, release all locks and abort
-                utils_unlock_set(shared_mem, transaction, nullptr);
-
-                delete transaction;
+                utils_abort(shared_mem, transaction);
                 return false;
             }
         }
 
     }
 
-    // Commit: write values and release locks
-    for (const auto& [addr, entry] : transaction->get_write_set()) {
-        memcpy((void*)addr, entry->new_value, entry->size_to_write);
+    bool refresh = history && transaction->count_commit() % history_refresh_period == 0;
+    if (history) {
+        // Keep the values about to be overwritten for snapshot readers. Nodes
+        // pushed for a commit that then fails are harmless: they hold the
+        // still-current value.
+        for (const WriteSetEntry& entry : transaction->get_write_set()) {
+            // History nodes hold single words, ranges are pushed word by word
+            WordRange words = utils_entry_words(entry);
+            for (size_t i = 0; i < entry.size_to_write / entry.word_size; i++) {
+                uint32_t stripe = entry.is_range() ? shared_mem->get_stripe(words, i) : entry.stripe;
+                const void* address = words.first + i * entry.word_size;
+                if (!history->push(tx, stripe, address, entry.word_size, transaction->get_wv())) {
+                    if (!transaction->is_irrevocable()) {
+                        utils_abort(shared_mem, transaction);
+                        return false;
+                    }
+                    history->push_waiting(tx, stripe, address, entry.word_size, transaction->get_wv());
+                }
+            }
+        }
+        if (refresh) {
+            history->refresh_horizon(shared_mem->get_clock().read_lower_bound(), ThreadRegistry::high_water());
+        }
+    }
+
+    // Irrevocable transactions claimed their frees in tm_free
+    if (!transaction->is_irrevocable() && !utils_claim_frees(shared_mem, transaction)) {
+        utils_abort(shared_mem, transaction);
+        return false;
+    }
+
+    // Commit: write values (encounter-time locking wrote them in place), then
+    // release each stripe once all its words are written
+    for (const WriteSetEntry& entry : transaction->get_write_set()) {
+        memcpy(entry.address, entry.new_value(), entry.size_to_write);
+    }
+    for (const LockedStripe& locked : transaction->get_locked()) {
+        if (history) {
+            history->truncate(tx, locked.stripe);
+        }
+        shared_mem->get_lock_at(locked.stripe)->update_version(transaction->get_wv());
+    }
+
+    // Snapshot readers starting after we return must see this commit
+    if (history) {
+        shared_mem->get_clock().settle(transaction->get_wv());
+        if (refresh) {
+            // Our locks are gone: cut the chains no later commit will truncate
+            history->sweep(tx, shared_mem->get_locks());
+        }
+    }
 
-        VersionedLock* lock = shared_mem->get_lock(addr);
-        lock->update_version(transaction->get_wv());
+    // Hand the segments we unlinked to the epoch manager
+    EpochManager& epochs = shared_mem->get_epochs();
+    epochs.exit(tx);
+    for (void* segment : transaction->get_frees()) {
+        epochs.retire(tx, segment);
     }
+    epochs.collect(tx);
 
     // Clean up
-    delete transaction;
+    utils_leave_gate(shared_mem, transaction);
+    shared_mem->get_mode().exit(tx);
+    transaction->commit(transaction->get_wv());
+    utils_report_stats(shared_mem, transaction);
     return true;
 }
 
@@ -183,74 +713,130 @@ bool tm_end(shared_t shared, tx_t tx) noexcept {
  * @return Whether the whole transaction can continue
 **/
 bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
-    std::cout << "TM_READ USER CALL:" << tx <<", " << *(int*)source << ", " << size << ", " << source << std::endl;
-    Transaction* transaction = reinterpret_cast<Transaction*>(tx);
+    Transaction* transaction = utils_get_transaction(tx);
+    TM_TRACE_EVENT(tx, read, 0, source, size);
     SharedMemory* shared_memory = static_cast<SharedMemory*>(shared);
     
     size_t align = shared_memory->get_align();
 
-    if (transaction->is_read_only_tx()) {
-        // For each word valid lock and version
-
+    WordRange words = shared_memory->translate(source);
+    if (transaction->is_captured(source, size)) {
+        // Our own new segment, nobody else can see it yet
         for (size_t i = 0; i < size / align; i++) {
-            void* source_word = (char*)source + i * align;
-            void* target_word = (char*)target + i * align;
-
-            // Check that lock is free and version is < read_version
-            VersionedLock* lock = shared_memory->get_lock(source_word);
-            uint64_t l = lock->load();
-            if (l & 0x1 || (l >> 1) > transaction->get_read_version()) {
-                std::cout << "CODE RED SHOULD NOT HAVE ENTERED \n\n\n\n\n\n\n\n\n" << std::endl;
-                delete transaction;
-                return false;
-            }
+            memcpy((char*)target + i * align, words.first + i * words.stride, align);
+        }
+        return true;
+    }
+
+    if (transaction->is_pessimistic()) {
+        // Under the global lock
+        utils_copy_words(words, target, size / align, align);
+        return true;
+    }
+
+    if (transaction->is_irrevocable()) {
+        // No other writer runs: the words are stable, read them directly
+        // (the multiversion mode still buffers our writes, see tm_write)
+        utils_copy_words(words, target, size / align, align);
+        utils_overlay_writes(transaction, words, target, size / align, align);
+        return true;
+    }
+
+    if (shared_memory->get_engine() == Engine::norec) {
+        // No colocated layout: the words are contiguous, read and logged as one range
+        if (!shared_memory->get_norec().read(transaction, words.first, target, size)) {
+            utils_abort(shared_memory, transaction);
+            return false;
+        }
+        utils_overlay_writes(transaction, words, target, size / align, align);
+        return true;
+    }
 
-            // Copy the word
-            std::cout << "GOOFY ASS READ OCMING RIGHT UP" << std::endl;
-            memcpy(target_word, source_word, align);
-            std::cout << "RESULT KRISTOF: " << *(int*)source_word << std::endl;
+    if (shared_memory->get_engine() == Engine::ring) {
+        // Sign the words, read them, then check the commits since our start
+        transaction->sign_read(words.first, size, align);
+        memcpy(target, words.first, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (!shared_memory->get_ring()->check(transaction)) {
+            utils_abort(shared_memory, transaction);
+            return false;
+        }
+        utils_overlay_writes(transaction, words, target, size / align, align);
+        return true;
+    }
 
-            // Post-validation that version hasn't changed
-            uint64_t afterl = lock->load();
-            if (afterl != l) {
-                std::cout << "CODE RED SHOULD NOT HAVE ENTERED 2 \n\n\n\n\n\n\n\n\n" << std::endl;
-                delete transaction;
+    if (transaction->is_read_only_tx() && shared_memory->get_history()) {
+        // Multiversion mode: read the snapshot, read-only transactions never abort
+        for (size_t i = 0; i < size / align; i++) {
+            utils_read_snapshot(shared_memory, transaction, shared_memory->get_stripe(words, i), words.first + i * words.stride, (char*)target + i * align, align);
+        }
+    }
+    else if (transaction->is_read_only_tx()) {
+        // Sample the lock of each run of words sharing a stripe: free and
+        // version <= read_version, extending the snapshot when possible
+        size_t count = size / align;
+        transaction->clear_samples();
+        for (size_t i = 0, end; i < count; i = end) {
+            end = shared_memory->stripe_run_end(words, i, count);
+            uint32_t stripe = shared_memory->get_stripe(words, i);
+            uint64_t l = utils_sample_lock(shared_memory, transaction, shared_memory->get_lock_at(stripe));
+            if (VersionedLock::is_locked(l) || VersionedLock::version_of(l) > transaction->get_read_version()) {
+                utils_abort(shared_memory, transaction);
                 return false;
             }
+            transaction->add_sample(stripe, l);
+        }
+
+        // Copy the words, then check once that no sampled version changed
+        // (read-only transactions only need a read set to be extended later)
+        utils_copy_words(words, target, count, align);
+        if (!utils_check_samples(shared_memory, transaction, shared_memory->extension_enabled())) {
+            utils_abort(shared_memory, transaction);
+            return false;
         }
     }
     else { // Standard case, Write Transaction
-        for (size_t i = 0; i < size / align; i++) {
-            void* target_word = (char*)target + i * align;
-            void* source_word = (char*)source + i * align;
+        bool eager = shared_memory->eager_locking();
+        bool written = !eager && !transaction->get_write_set().empty();
+        size_t count = size / align;
+        transaction->clear_samples();
+        for (size_t i = 0, end; i < count; i = end) {
+            end = shared_memory->stripe_run_end(words, i, count);
+            uint32_t stripe = shared_memory->get_stripe(words, i);
+            VersionedLock* lock = shared_memory->get_lock_at(stripe);
+            if (eager && utils_owned(lock, tx)) {
+                continue; // Our own stripe holds our latest writes
+            }
 
-            // Check if source_word has already been modified by transaction
-            std::unordered_map<void*, WriteSetEntry*> write_set = transaction->get_write_set();
-            if (write_set.find(source_word) != write_set.end()) {
-                memcpy(target_word, write_set[source_word]->new_value, align);
+            // The lock is only checked if a word of the run is not in the write set
+            bool all_written = written;
+            for (size_t k = i; all_written && k < end; k++) {
+                all_written = transaction->find_write(words.first + k * words.stride) != nullptr;
+            }
+            if (all_written) {
+                continue;
             }
-            else {
-                // Check that lock is free and version is <= read_version
-                VersionedLock* lock = shared_memory->get_lock(source_word);
-                uint64_t l = lock->load();
-                if (l & 0x1 || (l >> 1) > transaction->get_read_version()) {
-                    delete transaction;
-                    return false;
-                }
 
-                // Copy the word
-                memcpy(target_word, source_word, align);
+            // Check that lock is free and version is <= read_version, extending the snapshot when possible
+            uint64_t l = utils_sample_lock(shared_memory, transaction, lock);
+            if (VersionedLock::is_locked(l) || VersionedLock::version_of(l) > transaction->get_read_version()) {
+                utils_abort(shared_memory, transaction);
+                return false;
+            }
+            transaction->add_sample(stripe, l);
+        }
 
-                // Post-validation that version hasn't changed
-                uint64_t afterl = lock->load();
-                if (afterl != l) {
-                    delete transaction;
-                    return false;
-                }
+        // Copy the words, overlaid with the ones this transaction wrote
+        // (encounter-time locking writes in place, no write set)
+        utils_copy_words(words, target, count, align);
+        if (written) {
+            utils_overlay_writes(transaction, words, target, count, align);
+        }
 
-                // Add to read set
-                transaction->add_read(source_word, l >> 1);
-            }
+        // Post-validation that no sampled version changed, the stripes join the read set
+        if (!utils_check_samples(shared_memory, transaction, true)) {
+            utils_abort(shared_memory, transaction);
+            return false;
         }
     }
     return true;
@@ -265,17 +851,77 @@ bool tm_read(shared_t shared, tx_t tx, void const* source, size_t size, void* ta
  * @return Whether the whole transaction can continue
 **/
 bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* target) noexcept {
-    std::cout << "TM_WRITE USER CALL:" << tx <<", " << *(int*)target <<" -NOW- " <<  *(int*)source << ", " << target << std::endl;
-    Transaction* transaction = reinterpret_cast<Transaction*>(tx);
+    Transaction* transaction = utils_get_transaction(tx);
+    TM_TRACE_EVENT(tx, write, 0, target, size);
     SharedMemory* shared_mem = static_cast<SharedMemory*>(shared);
 
     size_t align = shared_mem->get_align();
-    for (size_t i = 0; i < size / align; i++) {
-        void* target_word = (char*)target + i * align;
-        void* source_word = (char*)source + i * align;
+    WordRange words = shared_mem->translate(target);
+    if (transaction->is_captured(target, size)) {
+        // Our own new segment, nobody else can see it yet: write in place, no
+        // log needed (an abort gives the whole segment back)
+        for (size_t i = 0; i < size / align; i++) {
+            memcpy(words.first + i * words.stride, (const char*)source + i * align, align);
+        }
+        return true;
+    }
+
+    if (transaction->is_pessimistic()) {
+        // Under the global lock, logged for an abort on an invalid free
+        for (size_t i = 0; i < size / align; i++) {
+            transaction->save_undo(words.first + i * words.stride, align);
+            memcpy(words.first + i * words.stride, (const char*)source + i * align, align);
+        }
+        return true;
+    }
+
+    if (transaction->is_irrevocable() && shared_mem->get_engine() != Engine::tl2) {
+        // The sequence lock (NOrec) or the full signature (RingSTM) keeps everybody else off memory
+        memcpy(words.first, source, size);
+        return true;
+    }
 
-       // Add to write set
-       transaction->add_write(target_word, source_word, shared_mem->get_version_clock(), size);
+    if (transaction->is_irrevocable() && !shared_mem->get_history()) {
+        // Write in place, unlogged: the transaction cannot abort. The
+        // multiversion mode buffers instead, the history is filled at commit
+        // from the values about to be overwritten.
+        size_t count = size / align;
+        for (size_t i = 0, end; i < count; i = end) {
+            end = shared_mem->stripe_run_end(words, i, count);
+            utils_write_irrevocable(shared_mem, transaction, tx, shared_mem->get_stripe(words, i), words, i, end, source, align);
+        }
+        return true;
+    }
+
+    if (shared_mem->eager_locking()) {
+        shared_mem->get_contention().on_lock(transaction);
+        size_t count = size / align;
+        for (size_t i = 0, end; i < count; i = end) {
+            end = shared_mem->stripe_run_end(words, i, count);
+            if (!utils_write_eager(shared_mem, transaction, tx, shared_mem->get_stripe(words, i), words, i, end, source, align)) {
+                utils_abort(shared_mem, transaction);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Contiguous fresh words are logged as one range entry
+    size_t count = size / align;
+    if (count > 1 && !words.colocated
+        && transaction->add_write_range(words.first, source, size, align, shared_mem->get_stripe(words, 0), words.stripe_shift)) {
+        return true;
+    }
+    for (size_t i = 0, end; i < count; i = end) {
+        end = shared_mem->stripe_run_end(words, i, count);
+        uint32_t stripe = shared_mem->get_stripe(words, i);
+        for (size_t k = i; k < end; k++) {
+            void* target_word = words.first + k * words.stride;
+            void* source_word = (char*)source + k * align;
+
+           // Add to write set (the word is copied into the transaction's log)
+           transaction->add_write(target_word, stripe, source_word, align);
+        }
     }
 
     return true;
@@ -289,24 +935,18 @@ bool tm_write(shared_t shared, tx_t tx, void const* source, size_t size, void* t
  * @return Whether the whole transaction can continue (success/nomem), or not (abort_alloc)
 **/
 Alloc tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) noexcept {
-    std::cout << "TM_ALLOC USER CALL:" << tx << size << *target << std::endl;
-    Transaction* transaction = reinterpret_cast<Transaction*>(tx);
+    Transaction* transaction = utils_get_transaction(tx);
     SharedMemory* shared_mem = static_cast<SharedMemory*>(shared);
 
     if (!shared || !transaction || !transaction->is_active() || size % shared_mem->get_align() != 0) {
-        std::cerr << "Invalid arguments" << std::endl;
         return Alloc::abort;
     }
 
-    // Allocate memory
-    void* new_location = aligned_alloc(shared_mem->get_align(), size);
+    // Allocate from the thread's cache, fresh or recycled blocks come zeroed
+    void* new_location = shared_mem->allocate_segment(tx, size);
     if (!new_location) return Alloc::nomem;
-
-    // Add to segments list
-    shared_mem->add_segment(new_location, size);
-
-    // Initialize segment words with 0s
-    memset(new_location, 0, size);
+    transaction->add_alloc(new_location, size);
+    TM_TRACE_EVENT(tx, alloc, 0, new_location, size);
 
     // Write target
     *target = new_location;
@@ -320,7 +960,36 @@ Alloc tm_alloc(shared_t shared, tx_t tx, size_t size, void** target) noexcept {
  * @param target Address of the first byte of the previously allocated segment to deallocate
  * @return Whether the whole transaction can continue
 **/
-// Will be cleaned at the end of the transaction
+// Recycled once the transaction commits and no concurrent transaction can still reach it
 bool tm_free(shared_t shared, tx_t tx, void* target) noexcept {
+    SharedMemory* shared_mem = static_cast<SharedMemory*>(shared);
+    Transaction* transaction = utils_get_transaction(tx);
+    if (transaction->is_irrevocable()) {
+        // Alone among writers: the segment leaves the live set right away.
+        // An invalid free cannot abort the transaction: it is ignored and
+        // counted (see tm_invalid_frees).
+        if (shared_mem->is_allocated_segment(target) && shared_mem->claim_segment(target)) {
+            transaction->add_free(target);
+        } else {
+            shared_mem->count_invalid_free();
+            TM_TRACE_EVENT(tx, invalid_free, 0, target, 0);
+        }
+        return true;
+    }
+    if (!shared_mem->is_allocated_segment(target) || !transaction->add_free(target)) {
+        // Not the start of a live segment from tm_alloc (or the first
+        // segment), or freed twice by the transaction
+        utils_abort(shared_mem, transaction);
+        return false;
+    }
+    TM_TRACE_EVENT(tx, free, 0, target, 0);
     return true;
 }
+
+/** [thread-safe] Number of invalid frees ignored by irrevocable transactions on the given shared memory region.
+ * @param shared Shared memory region to query
+ * @return Invalid frees ignored since the region was created
+**/
+size_t tm_invalid_frees(shared_t shared) noexcept {
+    return static_cast<SharedMemory*>(shared)->get_invalid_frees();
+}
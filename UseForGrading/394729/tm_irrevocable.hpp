@@ -0,0 +1,21 @@
+/**
+ * @file   tm_irrevocable.hpp
+ *
+ * @section DESCRIPTION
+ *
+ * Engine extension to the interface of tm.hpp: irrevocable transactions.
+**/
+
+#pragma once
+
+#include <tm.hpp>
+
+extern "C" {
+    // Begin a read-write transaction that runs alone among writers, on memory
+    // in place, and always commits. Ended with tm_end like any other.
+    tx_t tm_begin_irrevocable(shared_t) noexcept;
+    // Frees of segments that are not live (never allocated, or freed
+    // already) by irrevocable transactions: they cannot abort, so the free is
+    // ignored and counted here.
+    size_t tm_invalid_frees(shared_t) noexcept;
+}
@@ -0,0 +1,151 @@
+// Offline decoder of the trace files written by the `make trace` library.
+// Usage: trace_decode [-m] [trace file (default tm.trace)]
+// Prints, for every flush (destroyed region), the timeline of each thread
+// slot, or with -m a single timeline of all the slots merged by time. Times
+// are relative to the first event of the flush; each commit or abort shows
+// the duration of its attempt since the matching begin.
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <vector>
+#include "../Trace.hpp"
+
+namespace {
+
+struct Ring {
+    Trace::RingHeader header;
+    std::vector<Trace::Event> events;
+};
+
+const char* kind_name(uint16_t kind) {
+    static const char* const names[] = {"create", "destroy", "begin", "commit", "abort", "read", "write", "alloc", "free", "invalid free"};
+    return kind < sizeof(names) / sizeof(names[0]) ? names[kind] : "?";
+}
+
+void print_event(const Trace::Event& event, uint64_t origin, std::map<uint32_t, uint64_t>& begins, bool merged) {
+    std::printf("%14" PRIu64 "  ", event.time - origin);
+    if (merged) {
+        std::printf("slot %-4" PRIu32 "  ", event.slot);
+    }
+    std::printf("%-7s", kind_name(event.kind));
+    switch (static_cast<Trace::Kind>(event.kind)) {
+    case Trace::Kind::create:
+        std::printf(" size=%" PRIu64 " align=%" PRIu64, event.a, event.b);
+        break;
+    case Trace::Kind::begin:
+        std::printf(" %s%s%s rv=%" PRIu64,
+            event.flags & Trace::begin_read_only ? "ro" : "rw",
+            event.flags & Trace::begin_irrevocable ? " irrevocable" : "",
+            event.flags & Trace::begin_pessimistic ? " pessimistic" : "",
+            event.a);
+        begins[event.slot] = event.time;
+        break;
+    case Trace::Kind::commit:
+    case Trace::Kind::abort: {
+        std::printf(event.kind == static_cast<uint16_t>(Trace::Kind::commit) ? " wv=%" PRIu64 : " retries=%" PRIu64, event.a);
+        auto begin = begins.find(event.slot);
+        if (begin != begins.end()) {
+            std::printf("  (%" PRIu64 " since begin)", event.time - begin->second);
+            begins.erase(begin);
+        }
+        break;
+    }
+    case Trace::Kind::read:
+    case Trace::Kind::write:
+    case Trace::Kind::alloc:
+        std::printf(" 0x%" PRIx64 " %" PRIu64 " bytes", event.a, event.b);
+        break;
+    case Trace::Kind::free:
+    case Trace::Kind::invalid_free:
+        std::printf(" 0x%" PRIx64, event.a);
+        break;
+    default:
+        break;
+    }
+    std::printf("\n");
+}
+
+void print_flush(uint32_t flush, const std::vector<Ring>& rings, bool merged) {
+    uint64_t origin = UINT64_MAX;
+    for (const Ring& ring : rings) {
+        if (!ring.events.empty()) {
+            origin = std::min(origin, ring.events.front().time);
+        }
+    }
+    std::map<uint32_t, uint64_t> begins;
+    if (merged) {
+        std::vector<Trace::Event> events;
+        for (const Ring& ring : rings) {
+            events.insert(events.end(), ring.events.begin(), ring.events.end());
+        }
+        std::stable_sort(events.begin(), events.end(), [](const Trace::Event& x, const Trace::Event& y) { return x.time < y.time; });
+        std::printf("== flush %" PRIu32 " ==\n", flush);
+        for (const Trace::Event& event : events) {
+            print_event(event, origin, begins, true);
+        }
+        return;
+    }
+    for (const Ring& ring : rings) {
+        std::printf("== flush %" PRIu32 ", slot %" PRIu32 ": %" PRIu64 " events", flush, ring.header.slot, ring.header.count);
+        if (ring.header.dropped) {
+            std::printf(", %" PRIu64 " older ones dropped", ring.header.dropped);
+        }
+        std::printf(" ==\n");
+        uint64_t commits = 0, aborts = 0;
+        for (const Trace::Event& event : ring.events) {
+            print_event(event, origin, begins, false);
+            commits += event.kind == static_cast<uint16_t>(Trace::Kind::commit);
+            aborts += event.kind == static_cast<uint16_t>(Trace::Kind::abort);
+        }
+        std::printf("   %" PRIu64 " commits, %" PRIu64 " aborts\n", commits, aborts);
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    bool merged = false;
+    const char* path = "tm.trace";
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "-m") == 0) {
+            merged = true;
+        } else {
+            path = argv[i];
+        }
+    }
+
+    std::ifstream file(path, std::ios::binary);
+    Trace::FileHeader header;
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || std::memcmp(header.magic, Trace::file_magic, sizeof(header.magic)) != 0) {
+        std::fprintf(stderr, "%s: not a trace file\n", path);
+        return 1;
+    }
+    if (header.event_size != sizeof(Trace::Event)) {
+        std::fprintf(stderr, "%s: events of %" PRIu32 " bytes, expected %zu\n", path, header.event_size, sizeof(Trace::Event));
+        return 1;
+    }
+
+    // The rings of a flush are contiguous in the file
+    std::vector<Ring> rings;
+    Ring ring;
+    while (file.read(reinterpret_cast<char*>(&ring.header), sizeof(ring.header))) {
+        ring.events.resize(ring.header.count);
+        if (!file.read(reinterpret_cast<char*>(ring.events.data()), ring.header.count * sizeof(Trace::Event))) {
+            std::fprintf(stderr, "%s: truncated ring of slot %" PRIu32 "\n", path, ring.header.slot);
+            return 1;
+        }
+        if (!rings.empty() && rings.front().header.flush != ring.header.flush) {
+            print_flush(rings.front().header.flush, rings, merged);
+            rings.clear();
+        }
+        rings.push_back(ring);
+    }
+    if (!rings.empty()) {
+        print_flush(rings.front().header.flush, rings, merged);
+    }
+    return 0;
+}